@@ -0,0 +1,195 @@
+// allocators for mdarray storage:
+// * aligned_allocator - the default one, cache line (64 byte) aligned, so SIMD kernels can rely on
+//   aligned loads and no two arrays share a cache line;
+// * monotonic_arena + arena_allocator - pointer bump allocation from big pre-allocated blocks,
+//   deallocation is a no-op and the whole arena is rewound at once with reset(). Meant for
+//   short-lived temporaries in decoding loops: reset the arena once per frame and the temporaries
+//   cost a pointer bump instead of a malloc/free pair.
+
+#ifndef ECCPP_ALLOCATOR_H
+#define ECCPP_ALLOCATOR_H
+
+#include <new>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <algorithm>
+
+namespace eccpp {
+
+template <typename T, size_t Alignment = 64>
+class aligned_allocator {
+    static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0, "Invalid alignment");
+
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = aligned_allocator<U, Alignment>;
+    };
+
+    aligned_allocator() = default;
+
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment>&) {}
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+            throw std::bad_array_new_length();
+
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    friend bool operator==(const aligned_allocator&, const aligned_allocator<U, Alignment>&) { return true; }
+};
+
+class monotonic_arena {
+public:
+    static constexpr size_t alignment = 64;
+
+    explicit monotonic_arena(size_t block_size = size_t(1) << 20): block_size_(std::max<size_t>(block_size, alignment)) {}
+
+    monotonic_arena(const monotonic_arena&) = delete;
+    monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+    ~monotonic_arena() {
+        for (auto& b: blocks_)
+            ::operator delete(b.data, std::align_val_t(alignment));
+    }
+
+    void* allocate(size_t bytes, size_t align = alignment) {
+        if (!blocks_.empty()) {
+            auto& b = blocks_.back();
+            const size_t offset = (offset_ + align - 1) & ~(align - 1);
+            if (offset <= b.size && bytes <= b.size - offset) {
+                offset_ = offset + bytes;
+                return b.data + offset;
+            }
+        }
+
+        // new blocks are aligned to 64 bytes already
+        const size_t size = std::max(block_size_, bytes);
+        blocks_.push_back({static_cast<std::byte*>(::operator new(size, std::align_val_t(alignment))), size});
+        offset_ = bytes;
+        return blocks_.back().data;
+    }
+
+    // everything allocated from the arena becomes invalid. If the last frame needed more than a
+    // single block, the blocks are merged into one big block, so subsequent frames of the same
+    // size never have to allocate again
+    void reset() {
+        if (blocks_.size() > 1) {
+            size_t total = 0;
+            for (auto& b: blocks_) {
+                total += b.size;
+                ::operator delete(b.data, std::align_val_t(alignment));
+            }
+            blocks_.clear();
+            blocks_.push_back({static_cast<std::byte*>(::operator new(total, std::align_val_t(alignment))), total});
+        }
+        offset_ = 0;
+    }
+
+    // bytes handed out since the last reset (including alignment padding), current block only
+    size_t used() const { return blocks_.empty() ? 0 : offset_; }
+
+    size_t capacity() const {
+        size_t total = 0;
+        for (auto& b: blocks_)
+            total += b.size;
+
+        return total;
+    }
+
+    // arena picked up by default-constructed arena_allocators on this thread, see arena_scope
+    static monotonic_arena* current() { return current_ref(); }
+
+private:
+    friend class arena_scope;
+
+    static monotonic_arena*& current_ref() {
+        thread_local monotonic_arena* arena = nullptr;
+        return arena;
+    }
+
+    struct block {
+        std::byte* data;
+        size_t size;
+    };
+
+    size_t block_size_;
+    size_t offset_ = 0;
+    std::vector<block> blocks_;
+};
+
+// makes the arena current for this thread until the end of the scope
+class arena_scope {
+public:
+    explicit arena_scope(monotonic_arena& arena): prev_(monotonic_arena::current_ref()) {
+        monotonic_arena::current_ref() = &arena;
+    }
+
+    ~arena_scope() {
+        monotonic_arena::current_ref() = prev_;
+    }
+
+    arena_scope(const arena_scope&) = delete;
+    arena_scope& operator=(const arena_scope&) = delete;
+
+private:
+    monotonic_arena* prev_;
+};
+
+// allocates from the given arena, or from monotonic_arena::current() when default-constructed.
+// Without an arena it falls back to aligned heap allocation
+template <typename T>
+class arena_allocator {
+    template <typename U>
+    friend class arena_allocator;
+
+    monotonic_arena* arena_;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    arena_allocator(): arena_(monotonic_arena::current()) {}
+    explicit arena_allocator(monotonic_arena& arena): arena_(&arena) {}
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U>& other): arena_(other.arena_) {}
+
+    monotonic_arena* arena() const { return arena_; }
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+            throw std::bad_array_new_length();
+
+        if (!arena_)
+            return aligned_allocator<T>().allocate(n);
+
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), std::max(alignof(T), monotonic_arena::alignment)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        if (!arena_)
+            aligned_allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    friend bool operator==(const arena_allocator& lhs, const arena_allocator<U>& rhs) { return lhs.arena_ == rhs.arena_; }
+};
+
+} // namespace eccpp
+
+#endif // ECCPP_ALLOCATOR_H
@@ -0,0 +1,281 @@
+// packing of 0/1 element vectors into 64-bit words: element i is bit (i % 64) of word i / 64,
+// unused bits of the last word are always zero. Also the popcount kernels behind hamweight_packed()
+// and hamdist_packed(): AVX-512 VPOPCNTDQ, AVX2 Harley-Seal or POPCNT, whichever the CPU running
+// the code supports, picked once at runtime. Anywhere else Harley-Seal on plain 64-bit words
+
+#ifndef ECCPP_BITPACK_H
+#define ECCPP_BITPACK_H
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <bit>
+
+// GCC and Clang can build functions for an instruction set the rest of the program isn't built
+// for, so the x86-64 kernels are compiled in whatever the compiler flags are
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define ECCPP_POPCOUNT_DISPATCH 1
+#define ECCPP_TARGET(isa) __attribute__((target(isa)))
+#define ECCPP_ALWAYS_INLINE __attribute__((always_inline))
+#include <immintrin.h>
+#else
+#define ECCPP_ALWAYS_INLINE
+#endif
+
+namespace eccpp {
+
+constexpr size_t packed_words(size_t bits) {
+    return (bits + 63) / 64;
+}
+
+// the used bits of the last word of a packed vector of the given length
+constexpr std::uint64_t packed_tail_mask(size_t bits) {
+    return (bits % 64) ? (std::uint64_t(1) << (bits % 64)) - 1 : ~std::uint64_t(0);
+}
+
+template <typename T>
+std::vector<std::uint64_t> pack_bits(const std::vector<T>& bits) {
+    std::vector<std::uint64_t> packed(packed_words(bits.size()));
+    for (size_t i = 0; i < bits.size(); ++i) {
+        assert(bits[i] == 0 || bits[i] == 1);
+        packed[i / 64] |= std::uint64_t(bits[i] != 0) << (i % 64);
+    }
+    return packed;
+}
+
+template <typename T = int>
+std::vector<T> unpack_bits(const std::vector<std::uint64_t>& packed, size_t n) {
+    assert(packed.size() >= packed_words(n));
+
+    std::vector<T> bits(n);
+    for (size_t i = 0; i < n; ++i)
+        bits[i] = T((packed[i / 64] >> (i % 64)) & 1);
+
+    return bits;
+}
+
+namespace detail {
+
+// std::popcount, which without a popcount instruction (-mpopcnt or newer) ends up as a library call
+inline std::uint64_t popcount64(std::uint64_t v) {
+#if defined(__POPCNT__)
+    return std::uint64_t(std::popcount(v));
+#else
+    v = v - ((v >> 1) & 0x5555555555555555ull);
+    v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+    v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (v * 0x0101010101010101ull) >> 56;
+#endif
+}
+
+// GCC notes that a 256-bit vector passed by value to a function built without AVX has a different
+// ABI. csa() and harley_seal() below are always inlined into the kernels, so there's no such call
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+// carry-save adder, bitwise: high:low = a + b + c. Works for vector types as well (GCC / Clang
+// vector extensions), always inlined so it gets the instruction set of the kernel it's used in
+template <typename V>
+ECCPP_ALWAYS_INLINE inline void csa(V& high, V& low, const V& a, const V& b, const V& c) {
+    const V u = a ^ b;
+    high = (a & b) | (u & c);
+    low = u ^ c;
+}
+
+// Harley-Seal: 16 blocks go through a tree of carry-save adders, which leaves a single block of
+// "sixteens" to actually count. load(i) gives block i, count() the popcount of a block
+template <typename V, typename Load, typename Count>
+ECCPP_ALWAYS_INLINE inline std::uint64_t harley_seal(size_t blocks, Load load, Count count) {
+    V ones{}, twos{}, fours{}, eights{}, sixteens{};
+    V twos_a, twos_b, fours_a, fours_b, eights_a, eights_b;
+    std::uint64_t total = 0;
+
+    size_t i = 0;
+    if (blocks < 16) {
+        for (; i < blocks; ++i)
+            total += count(load(i));
+        return total;
+    }
+
+    for (; i + 16 <= blocks; i += 16) {
+        csa(twos_a, ones, ones, load(i), load(i + 1));
+        csa(twos_b, ones, ones, load(i + 2), load(i + 3));
+        csa(fours_a, twos, twos, twos_a, twos_b);
+        csa(twos_a, ones, ones, load(i + 4), load(i + 5));
+        csa(twos_b, ones, ones, load(i + 6), load(i + 7));
+        csa(fours_b, twos, twos, twos_a, twos_b);
+        csa(eights_a, fours, fours, fours_a, fours_b);
+        csa(twos_a, ones, ones, load(i + 8), load(i + 9));
+        csa(twos_b, ones, ones, load(i + 10), load(i + 11));
+        csa(fours_a, twos, twos, twos_a, twos_b);
+        csa(twos_a, ones, ones, load(i + 12), load(i + 13));
+        csa(twos_b, ones, ones, load(i + 14), load(i + 15));
+        csa(fours_b, twos, twos, twos_a, twos_b);
+        csa(eights_b, fours, fours, fours_a, fours_b);
+        csa(sixteens, eights, eights, eights_a, eights_b);
+        total += count(sixteens);
+    }
+
+    total = 16 * total + 8 * count(eights) + 4 * count(fours) + 2 * count(twos) + count(ones);
+    for (; i < blocks; ++i)
+        total += count(load(i));
+
+    return total;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// popcount_words() implementations, popcount_isa_supported() tells which ones the CPU can run
+enum class popcount_isa {
+    generic,    // Harley-Seal on 64-bit words, SWAR popcount unless built with -mpopcnt
+    popcnt,     // a POPCNT per word
+    avx2,       // Harley-Seal on 256-bit blocks, nibble lookup popcount
+    avx512      // VPOPCNTDQ, 8 words per instruction
+};
+
+using popcount_kernel = std::uint64_t (*)(const std::uint64_t*, const std::uint64_t*, size_t);
+
+// set bits over n words: of a[i] for a weight (b isn't read then) or of a[i] ^ b[i] for a distance.
+// Without a popcount instruction a popcount is a dozen operations, Harley-Seal needs
+// about one per 16 words
+template <bool Xor>
+std::uint64_t popcount_words_generic(const std::uint64_t* a, const std::uint64_t* b, size_t n) {
+    auto load = [a, b](size_t i) { return Xor ? a[i] ^ b[i] : a[i]; };
+    return harley_seal<std::uint64_t>(n, load, popcount64);
+}
+
+#if defined(ECCPP_POPCOUNT_DISPATCH)
+
+template <bool Xor>
+ECCPP_TARGET("popcnt") std::uint64_t popcount_words_popcnt(const std::uint64_t* a, const std::uint64_t* b, size_t n) {
+    std::uint64_t total = 0;
+    for (size_t i = 0; i < n; ++i)
+        total += std::uint64_t(__builtin_popcountll(Xor ? a[i] ^ b[i] : a[i]));
+    return total;
+}
+
+// nibble lookup with a byte shuffle, then summed up by SAD against zero
+ECCPP_TARGET("avx2") inline std::uint64_t popcount_256(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    const __m256i lo = _mm256_and_si256(v, low_mask);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    const __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    const __m256i sums = _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+    return std::uint64_t(_mm256_extract_epi64(sums, 0)) + std::uint64_t(_mm256_extract_epi64(sums, 1)) +
+        std::uint64_t(_mm256_extract_epi64(sums, 2)) + std::uint64_t(_mm256_extract_epi64(sums, 3));
+}
+
+// function objects rather than lambdas: a lambda doesn't get the target of the function it's in
+template <bool Xor>
+struct popcount_avx2_load {
+    const std::uint64_t* a;
+    const std::uint64_t* b;
+
+    ECCPP_TARGET("avx2") __m256i operator()(size_t block) const {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + block * 4));
+        if constexpr (Xor)
+            return _mm256_xor_si256(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + block * 4)));
+        else
+            return v;
+    }
+};
+
+struct popcount_avx2_count {
+    ECCPP_TARGET("avx2") std::uint64_t operator()(__m256i v) const { return popcount_256(v); }
+};
+
+template <bool Xor>
+ECCPP_TARGET("avx2,popcnt") std::uint64_t popcount_words_avx2(const std::uint64_t* a, const std::uint64_t* b, size_t n) {
+    std::uint64_t total = harley_seal<__m256i>(n / 4, popcount_avx2_load<Xor>{a, b}, popcount_avx2_count{});
+    for (size_t i = n / 4 * 4; i < n; ++i)
+        total += std::uint64_t(__builtin_popcountll(Xor ? a[i] ^ b[i] : a[i]));
+    return total;
+}
+
+template <bool Xor>
+ECCPP_TARGET("avx512f,avx512vpopcntdq") std::uint64_t popcount_words_avx512(const std::uint64_t* a, const std::uint64_t* b, size_t n) {
+    __m512i total = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m512i v = _mm512_loadu_si512(a + i);
+        if constexpr (Xor)
+            v = _mm512_xor_si512(v, _mm512_loadu_si512(b + i));
+        total = _mm512_add_epi64(total, _mm512_popcnt_epi64(v));
+    }
+    if (i < n) {
+        const __mmask8 mask = __mmask8((1u << (n - i)) - 1);
+        __m512i v = _mm512_maskz_loadu_epi64(mask, a + i);
+        if constexpr (Xor)
+            v = _mm512_xor_si512(v, _mm512_maskz_loadu_epi64(mask, b + i));
+        total = _mm512_add_epi64(total, _mm512_popcnt_epi64(v));
+    }
+
+    // _mm512_reduce_add_epi64() trips a bogus -Wuninitialized in GCC 12 under a target attribute
+    std::uint64_t lanes[8];
+    _mm512_storeu_si512(lanes, total);
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+}
+
+#endif
+
+inline bool popcount_isa_supported(popcount_isa isa) {
+#if defined(ECCPP_POPCOUNT_DISPATCH)
+    __builtin_cpu_init();
+    switch (isa) {
+    case popcount_isa::generic:
+        return true;
+    case popcount_isa::popcnt:
+        return __builtin_cpu_supports("popcnt");
+    case popcount_isa::avx2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    case popcount_isa::avx512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq");
+    }
+    return false;
+#else
+    return isa == popcount_isa::generic;
+#endif
+}
+
+// the kernel for isa, which must be supported
+template <bool Xor>
+popcount_kernel popcount_words_kernel(popcount_isa isa) {
+    switch (isa) {
+#if defined(ECCPP_POPCOUNT_DISPATCH)
+    case popcount_isa::popcnt:
+        return popcount_words_popcnt<Xor>;
+    case popcount_isa::avx2:
+        return popcount_words_avx2<Xor>;
+    case popcount_isa::avx512:
+        return popcount_words_avx512<Xor>;
+#endif
+    default:
+        return popcount_words_generic<Xor>;
+    }
+}
+
+inline popcount_isa popcount_best_isa() {
+    for (auto isa: {popcount_isa::avx512, popcount_isa::avx2, popcount_isa::popcnt})
+        if (popcount_isa_supported(isa))
+            return isa;
+    return popcount_isa::generic;
+}
+
+// the best kernel for the CPU, looked up on the first call
+template <bool Xor>
+inline std::uint64_t popcount_words(const std::uint64_t* a, const std::uint64_t* b, size_t n) {
+    static const popcount_kernel kernel = popcount_words_kernel<Xor>(popcount_best_isa());
+    return kernel(a, b, n);
+}
+
+} // namespace detail
+
+} // namespace eccpp
+
+#endif // ECCPP_BITPACK_H
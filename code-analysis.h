@@ -0,0 +1,134 @@
+// weight spectrum of binary linear codes by exhaustive enumeration. For a linear code the distance
+// between two codewords is the weight of their sum, which is a codeword too, so the minimum distance
+// is the smallest nonzero weight and the weight enumerator is the whole distance profile, no pairs
+// needed. The 2^k messages are walked in Gray code order: the next codeword is the current one
+// XORed with a single generator row, then its packed words are popcounted (hamweight_packed()).
+
+#ifndef ECCPP_CODE_ANALYSIS_H
+#define ECCPP_CODE_ANALYSIS_H
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <cstdint>
+#include <bit>
+#include <stdexcept>
+
+#include "execution.h"
+#include "gf2-matrix.h"
+#include "gn.h"
+#include "hamweight.h"
+#include "shuffle.h"
+
+namespace eccpp {
+
+struct weight_spectrum {
+    std::vector<std::uint64_t> weights;     // weights[w] - number of codewords of Hamming weight w, w = 0..n
+    size_t min_distance = 0;                // smallest nonzero weight, 0 if there is none
+    std::uint64_t multiplicity = 0;         // number of codewords of weight min_distance
+};
+
+// the code spanned by the rows of generator, one codeword per message: if the rows are linearly
+// dependent, every codeword is counted 2^(rows - rank) times. A parallel policy splits the
+// messages into contiguous ranges, one per thread
+template <execution_policy P>
+weight_spectrum weight_enumerator(P policy, const gf2_matrix& generator) {
+    const size_t k = generator.rows();
+    const size_t n = generator.cols();
+    const size_t words = generator.words_per_row();
+    if (k >= 64)
+        throw std::invalid_argument("Too many generator rows to enumerate");
+
+    const std::uint64_t count = std::uint64_t(1) << k;
+
+    size_t threads = 1;
+    if constexpr (is_parallel_policy_v<P>) {
+        threads = policy.threads ? policy.threads : std::max(1u, std::thread::hardware_concurrency());
+
+        // a codeword costs about 2 * words operations, same minimum amount of work per thread as
+        // for_each_range()
+        const std::uint64_t min_codewords = std::max<size_t>(1, detail::min_parallel_elements / words);
+        threads = size_t(std::min<std::uint64_t>(threads, (count + min_codewords - 1) / min_codewords));
+    }
+
+    std::vector<std::vector<std::uint64_t>> histograms(threads, std::vector<std::uint64_t>(n + 1));
+    auto enumerate = [&](size_t t) {
+        const std::uint64_t begin = count / threads * t + std::min<std::uint64_t>(t, count % threads);
+        const std::uint64_t end = begin + count / threads + (t < count % threads);
+        auto& histogram = histograms[t];
+
+        // the codeword of the first message, Gray code of begin
+        std::vector<std::uint64_t> codeword(words);
+        for (auto bits = begin ^ (begin >> 1); bits; bits &= bits - 1) {
+            const std::uint64_t* row = generator.row(size_t(std::countr_zero(bits)));
+            for (size_t w = 0; w < words; ++w)
+                codeword[w] ^= row[w];
+        }
+        ++histogram[hamweight_packed(codeword)];
+
+        // Gray codes of i - 1 and i differ in bit countr_zero(i)
+        for (std::uint64_t i = begin + 1; i < end; ++i) {
+            const std::uint64_t* row = generator.row(size_t(std::countr_zero(i)));
+            std::uint64_t* c = codeword.data();
+            ECCPP_SIMD_LOOP
+            for (size_t w = 0; w < words; ++w)
+                c[w] ^= row[w];
+
+            ++histogram[hamweight_packed(codeword)];
+        }
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t t = 1; t < threads; ++t)
+        workers.emplace_back(enumerate, t);
+    enumerate(0);
+    for (auto& w: workers)
+        w.join();
+
+    weight_spectrum result;
+    result.weights.assign(n + 1, 0);
+    for (const auto& histogram: histograms)
+        for (size_t w = 0; w <= n; ++w)
+            result.weights[w] += histogram[w];
+
+    for (size_t w = 1; w <= n; ++w)
+        if (result.weights[w]) {
+            result.min_distance = w;
+            result.multiplicity = result.weights[w];
+            break;
+        }
+
+    return result;
+}
+
+inline weight_spectrum weight_enumerator(const gf2_matrix& generator) {
+    return weight_enumerator(execution::seq, generator);
+}
+
+// generator matrix of the polar code polar_enc_butterfly(n, permutation_seed) produces with the
+// given info bits: the rows of G_n at info_bits, in that order, with the columns shuffled the same
+// way the codeword bits are. Shuffling doesn't change any weight, the codewords themselves do
+// change though
+inline gf2_matrix polar_generator(size_t n, const std::vector<size_t>& info_bits, std::uint_fast32_t permutation_seed = 0) {
+    const gn_view gn(n);
+    if (info_bits.empty())
+        throw std::invalid_argument("Info bits must not be empty");
+
+    const shuffle_perm perm = permutation_seed ? shuffle_perm(n, permutation_seed) : shuffle_perm();
+    gf2_matrix result(info_bits.size(), n);
+    std::vector<int> shuffled(n);
+    for (size_t i = 0; i < info_bits.size(); ++i) {
+        auto row = gn.row(info_bits[i]);
+        if (!perm.empty()) {
+            perm.shuffle(row, shuffled);
+            row.swap(shuffled);
+        }
+        result.set_packed_row(i, pack_bits(row));
+    }
+    return result;
+}
+
+} // namespace eccpp
+
+#endif // ECCPP_CODE_ANALYSIS_H
@@ -0,0 +1,275 @@
+// einsum-style contraction of one or two mdarrays over arbitrary axes, e.g.:
+//   einsum("ij,jk->ik", a, b)  - matrix product
+//   einsum("ij->ji", a)        - transpose
+//   einsum("lk,lk->l", a, b)   - per-row dot products (batched LLR / path metric updates)
+//   einsum("ii->", a)          - trace
+// Labels missing from the output are summed over, a label repeated within an operand takes
+// its diagonal. Every (spec, shapes) combination is compiled once into a contraction_plan:
+// a stride-based loop nest with the smallest-stride loop innermost and compatible loops fused.
+// einsum() caches the plans per thread, or a plan can be kept and reused explicitly.
+
+#ifndef ECCPP_EINSUM_H
+#define ECCPP_EINSUM_H
+
+#include <vector>
+#include <string>
+#include <array>
+#include <algorithm>
+#include <unordered_map>
+#include <stdexcept>
+
+#include "mdarray.h"
+
+namespace eccpp {
+
+class contraction_plan {
+public:
+    contraction_plan(const std::string& spec, const std::vector<size_t>& lhs_dims, const std::vector<size_t>& rhs_dims = {}) {
+        std::string s;
+        for (auto ch: spec)
+            if (ch != ' ')
+                s += ch;
+
+        const auto arrow = s.find("->");
+        if (arrow == std::string::npos)
+            throw std::invalid_argument("einsum: spec must contain '->'");
+
+        const auto inputs = s.substr(0, arrow);
+        const auto output = s.substr(arrow + 2);
+        const auto comma = inputs.find(',');
+        std::array<std::string, 2> operand_labels = {inputs.substr(0, comma), comma == std::string::npos ? "" : inputs.substr(comma + 1)};
+        operands_ = comma == std::string::npos ? 1 : 2;
+
+        if (operands_ == 2 && operand_labels[1].find(',') != std::string::npos)
+            throw std::invalid_argument("einsum: at most two operands are supported");
+
+        const std::array<const std::vector<size_t>*, 2> dims = {&lhs_dims, &rhs_dims};
+        std::array<size_t, 128> extent = {};
+        std::array<std::array<size_t, 128>, 3> strides = {};
+
+        for (size_t op = 0; op < operands_; ++op) {
+            const auto& labels = operand_labels[op];
+            const auto& d = *dims[op];
+            if (labels.size() != d.size())
+                throw std::invalid_argument("einsum: number of labels does not match operand rank");
+
+            size_t stride = 1;
+            for (size_t i = labels.size(); i-- > 0; ) {
+                const auto label = check_label(labels[i]);
+                if (extent[label] && extent[label] != d[i])
+                    throw std::invalid_argument("einsum: extent mismatch for label");
+
+                extent[label] = d[i];
+                strides[op][label] += stride;
+                stride *= d[i];
+            }
+        }
+
+        size_t stride = 1;
+        for (size_t i = output.size(); i-- > 0; ) {
+            const auto label = check_label(output[i]);
+            if (!extent[label])
+                throw std::invalid_argument("einsum: output label not present in the operands");
+            if (strides[2][label])
+                throw std::invalid_argument("einsum: repeated output label");
+
+            strides[2][label] = stride;
+            stride *= extent[label];
+        }
+
+        for (auto label: output)
+            result_dims_.push_back(extent[size_t(label)]);
+        if (result_dims_.empty())
+            result_dims_.push_back(1);
+
+        lhs_dims_ = lhs_dims;
+        if (operands_ == 2)
+            rhs_dims_ = rhs_dims;
+
+        for (size_t label = 0; label < extent.size(); ++label)
+            if (extent[label])
+                loops_.push_back({extent[label], {strides[0][label], strides[1][label], strides[2][label]}});
+
+        // largest combined stride outermost, so the innermost loop walks memory with unit stride
+        // wherever the operands allow it
+        std::stable_sort(loops_.begin(), loops_.end(), [](const loop& a, const loop& b) {
+            return a.stride[0] + a.stride[1] + a.stride[2] > b.stride[0] + b.stride[1] + b.stride[2];
+        });
+
+        // fuse neighbours which together form a single strided sweep in every operand
+        std::vector<loop> fused;
+        for (const auto& l: loops_) {
+            if (!fused.empty()) {
+                auto& outer = fused.back();
+                bool fusable = true;
+                for (size_t i = 0; i < 3; ++i)
+                    fusable = fusable && outer.stride[i] == l.stride[i] * l.extent;
+
+                if (fusable) {
+                    outer = {outer.extent * l.extent, l.stride};
+                    continue;
+                }
+            }
+            fused.push_back(l);
+        }
+        loops_ = std::move(fused);
+    }
+
+    size_t operands() const { return operands_; }
+    const std::vector<size_t>& result_dimensions() const { return result_dims_; }
+
+    template <typename T, typename A>
+    mdarray<T, A> operator()(const mdarray<T, A>& lhs, const mdarray<T, A>& rhs) const {
+        mdarray<T, A> out(result_dims_, lhs.get_allocator());
+        execute(lhs, rhs, out);
+        return out;
+    }
+
+    template <typename T, typename A>
+    mdarray<T, A> operator()(const mdarray<T, A>& operand) const {
+        mdarray<T, A> out(result_dims_, operand.get_allocator());
+        execute(operand, out);
+        return out;
+    }
+
+    // out is overwritten, it must already have the result dimensions
+    template <typename T, typename A>
+    void execute(const mdarray<T, A>& lhs, const mdarray<T, A>& rhs, mdarray<T, A>& out) const {
+        if (operands_ != 2)
+            throw std::invalid_argument("einsum: plan expects a single operand");
+        if (rhs.dimensions() != rhs_dims_)
+            throw std::invalid_argument("einsum: operand dimensions do not match the plan");
+
+        run(lhs, rhs.data(), out);
+    }
+
+    template <typename T, typename A>
+    void execute(const mdarray<T, A>& operand, mdarray<T, A>& out) const {
+        if (operands_ != 1)
+            throw std::invalid_argument("einsum: plan expects two operands");
+
+        run<T, A>(operand, nullptr, out);
+    }
+
+private:
+    struct loop {
+        size_t extent;
+        std::array<size_t, 3> stride;   // lhs, rhs, out
+    };
+
+    static size_t check_label(char label) {
+        if (!((label >= 'a' && label <= 'z') || (label >= 'A' && label <= 'Z')))
+            throw std::invalid_argument("einsum: labels must be letters");
+
+        return size_t(label);
+    }
+
+    template <typename T, typename A>
+    void run(const mdarray<T, A>& lhs, const T* rhs, mdarray<T, A>& out) const {
+        if (lhs.dimensions() != lhs_dims_)
+            throw std::invalid_argument("einsum: operand dimensions do not match the plan");
+        if (out.dimensions() != result_dims_)
+            throw std::invalid_argument("einsum: output dimensions do not match the plan");
+
+        T* o = out.data();
+        std::fill(o, o + out.size(), T());
+
+        const T* l = lhs.data();
+        const auto& inner = loops_.back();
+        const size_t n = inner.extent;
+        const auto [sl, sr, so] = inner.stride;
+        const size_t outer_loops = loops_.size() - 1;
+        std::vector<size_t> counter(outer_loops, 0);
+
+        while (true) {
+            if (rhs) {
+                for (size_t i = 0; i < n; ++i)
+                    o[i * so] += l[i * sl] * rhs[i * sr];
+            }
+            else {
+                for (size_t i = 0; i < n; ++i)
+                    o[i * so] += l[i * sl];
+            }
+
+            // odometer over the outer loops, innermost first
+            size_t i = outer_loops;
+            for (; i-- > 0; ) {
+                const auto& lp = loops_[i];
+                l += lp.stride[0];
+                if (rhs)
+                    rhs += lp.stride[1];
+                o += lp.stride[2];
+
+                if (++counter[i] < lp.extent)
+                    break;
+
+                l -= lp.stride[0] * lp.extent;
+                if (rhs)
+                    rhs -= lp.stride[1] * lp.extent;
+                o -= lp.stride[2] * lp.extent;
+                counter[i] = 0;
+            }
+            if (i == size_t(-1))
+                break;
+        }
+    }
+
+    size_t operands_ = 1;
+    std::vector<size_t> lhs_dims_;
+    std::vector<size_t> rhs_dims_;
+    std::vector<size_t> result_dims_;
+    std::vector<loop> loops_;   // outermost first
+};
+
+namespace detail {
+
+inline const contraction_plan& cached_contraction_plan(const std::string& spec, const std::vector<size_t>& lhs_dims, const std::vector<size_t>& rhs_dims) {
+    // the number of distinct shapes in a decoder is small, the cap is just a safety net
+    constexpr size_t max_cached_plans = 256;
+    thread_local std::unordered_map<std::string, contraction_plan> cache;
+
+    std::string key = spec;
+    for (const auto* dims: {&lhs_dims, &rhs_dims}) {
+        key += '|';
+        for (auto d: *dims)
+            key += std::to_string(d) + ',';
+    }
+
+    auto it = cache.find(key);
+    if (it != cache.end())
+        return it->second;
+
+    if (cache.size() >= max_cached_plans)
+        cache.clear();
+
+    return cache.emplace(std::move(key), contraction_plan(spec, lhs_dims, rhs_dims)).first->second;
+}
+
+} // namespace detail
+
+template <typename T, typename A>
+mdarray<T, A> einsum(const std::string& spec, const mdarray<T, A>& lhs, const mdarray<T, A>& rhs) {
+    const auto& plan = detail::cached_contraction_plan(spec, lhs.dimensions(), rhs.dimensions());
+    return plan(lhs, rhs);
+}
+
+template <typename T, typename A>
+mdarray<T, A> einsum(const std::string& spec, const mdarray<T, A>& operand) {
+    const auto& plan = detail::cached_contraction_plan(spec, operand.dimensions(), {});
+    return plan(operand);
+}
+
+// in-place variants writing into an existing array of the result dimensions
+template <typename T, typename A>
+void einsum_into(const std::string& spec, const mdarray<T, A>& lhs, const mdarray<T, A>& rhs, mdarray<T, A>& out) {
+    detail::cached_contraction_plan(spec, lhs.dimensions(), rhs.dimensions()).execute(lhs, rhs, out);
+}
+
+template <typename T, typename A>
+void einsum_into(const std::string& spec, const mdarray<T, A>& operand, mdarray<T, A>& out) {
+    detail::cached_contraction_plan(spec, operand.dimensions(), {}).execute(operand, out);
+}
+
+} // namespace eccpp
+
+#endif // ECCPP_EINSUM_H
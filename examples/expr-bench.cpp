@@ -0,0 +1,57 @@
+// D = (A + B - C + E - F) * 0.5: fused element-wise expression vs evaluating it
+// one operator at a time with a materialised temporary per step
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <tuple>
+#include <vector>
+
+#include "mdarray.h"
+
+template <typename Fn>
+static double milliseconds(int iterations, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        fn();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+int main() {
+    const size_t n = 10000000;
+    const int iterations = 10;
+
+    std::vector<eccpp::mdarray<float>> ops;
+    for (int k = 0; k < 5; ++k) {
+        ops.emplace_back(std::vector<size_t>{n});
+        for (size_t i = 0; i < n; ++i)
+            ops.back().data()[i] = float((i * (k + 3)) % 101);
+    }
+    const auto& [A, B, C, E, F] = std::tie(ops[0], ops[1], ops[2], ops[3], ops[4]);
+    eccpp::mdarray<float> D({n});
+
+    const auto t_eager = milliseconds(iterations, [&] {
+        eccpp::mdarray<float> t1 = A;
+        t1 += B;
+        eccpp::mdarray<float> t2 = t1;
+        t2 -= C;
+        eccpp::mdarray<float> t3 = t2;
+        t3 += E;
+        eccpp::mdarray<float> t4 = t3;
+        t4 -= F;
+        eccpp::mdarray<float> t5 = t4;
+        t5 *= 0.5f;
+        D = t5;
+    });
+
+    const auto t_fused = milliseconds(iterations, [&] {
+        D = (A + B - C + E - F) * 0.5f;
+    });
+
+    // 5 operands read + result written vs 5 copies, 5 read-modify-write passes and a final copy
+    std::cout << std::fixed << std::setprecision(2) <<
+        "\n" << n << " floats, 5 operands:\n" <<
+        "eager: " << std::setw(8) << t_eager << " ms\n" <<
+        "fused: " << std::setw(8) << t_fused << " ms (x" << t_eager / t_fused << ")\n";
+}
@@ -0,0 +1,176 @@
+// hamdist / hamweight / phi: flat kernels over contiguous data vs the previous multi-index
+// odometer walk with a bounds-checked element access per element, for ranks 1 to 4 with the
+// same total number of elements. Then hamdist / hamweight on int elements against the packed
+// popcount versions, and the in-place list update phi_inplace() in its three modes against the
+// old copying log(1 + exp(x)) loop
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <cmath>
+
+#include "hamdist.h"
+#include "hamweight.h"
+#include "phi.h"
+
+template <typename Fn>
+static double milliseconds(int iterations, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        fn();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+// calls fn(indices) for every multi-index in row-major order, the way the old kernels did
+template <typename Fn>
+static void odometer(const std::vector<size_t>& dims, Fn&& fn) {
+    std::vector<size_t> indices(dims.size(), 0);
+    while (true) {
+        fn(indices);
+
+        bool done = true;
+        for (int i = dims.size() - 1; i >= 0; --i) {
+            if (indices[i] + 1 < dims[i]) {
+                ++indices[i];
+                done = false;
+                break;
+            }
+            else
+                indices[i] = 0;
+        }
+        if (done)
+            break;
+    }
+}
+
+static size_t odometer_hamdist(const eccpp::mdarray<int>& a, const eccpp::mdarray<int>& b) {
+    size_t distance = 0;
+    odometer(a.dimensions(), [&](const std::vector<size_t>& idx) { distance += a(idx) != b(idx); });
+    return distance;
+}
+
+static size_t odometer_hamweight(const eccpp::mdarray<int>& a) {
+    size_t weight = 0;
+    odometer(a.dimensions(), [&](const std::vector<size_t>& idx) { weight += a(idx) != 0; });
+    return weight;
+}
+
+static eccpp::mdarray<float> odometer_phi(const eccpp::mdarray<float>& pm, const eccpp::mdarray<float>& llr, float u) {
+    eccpp::mdarray<float> result = pm;
+    odometer(pm.dimensions(), [&](const std::vector<size_t>& idx) {
+        const float l = llr(idx);
+        if (0.5f * (1.0f - eccpp::sign(l)) != u)
+            result(idx) += std::abs(l);
+    });
+    return result;
+}
+
+int main() {
+    const size_t n = size_t(1) << 20;
+    const int iterations = 10;
+
+    const std::vector<std::vector<size_t>> shapes = {{n}, {1024, 1024}, {64, 128, 128}, {16, 32, 64, 32}};
+
+    std::cout << std::fixed << std::setprecision(3) << "\n" << n << " elements\n" <<
+        "rank      kernel   odometer, ms   flat, ms   speedup\n";
+
+    for (const auto& dims: shapes) {
+        eccpp::mdarray<int> a(dims), b(dims);
+        eccpp::mdarray<float> pm(dims), llr(dims);
+        for (size_t i = 0; i < n; ++i) {
+            a.data()[i] = int((i * 2654435761u) >> 31 & 1);
+            b.data()[i] = int((i * 40503u) >> 7 & 1);
+            pm.data()[i] = float(i % 13);
+            llr.data()[i] = float(int(i % 17) - 8);
+        }
+
+        volatile size_t sink = 0;
+        auto report = [&](const char* name, double t_odometer, double t_flat) {
+            std::cout << std::setw(4) << dims.size() << std::setw(12) << name << std::setw(15) << t_odometer <<
+                std::setw(11) << t_flat << std::setw(9) << std::setprecision(1) << t_odometer / t_flat << "x\n" <<
+                std::setprecision(3);
+        };
+
+        report("hamdist",
+               milliseconds(iterations, [&] { sink = sink + odometer_hamdist(a, b); }),
+               milliseconds(iterations, [&] { sink = sink + eccpp::hamdist(a, b); }));
+
+        report("hamweight",
+               milliseconds(iterations, [&] { sink = sink + odometer_hamweight(a); }),
+               milliseconds(iterations, [&] { sink = sink + eccpp::hamweight(a); }));
+
+        report("phi",
+               milliseconds(iterations, [&] { sink = sink + size_t(odometer_phi(pm, llr, 1.0f).data()[1]); }),
+               milliseconds(iterations, [&] { sink = sink + size_t(eccpp::phi(pm, llr, 1.0f, true).data()[1]); }));
+    }
+
+    {
+        std::vector<int> a(n), b(n);
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = int((i * 2654435761u) >> 31 & 1);
+            b[i] = int((i * 40503u) >> 7 & 1);
+        }
+        const auto pa = eccpp::pack_bits(a);
+        const auto pb = eccpp::pack_bits(b);
+
+        volatile size_t sink = 0;
+        std::cout << "\n" << n << " bits\nkernel      int elements, ms   packed, ms   speedup\n";
+        auto report = [&](const char* name, double t_int, double t_packed) {
+            std::cout << std::left << std::setw(12) << name << std::right << std::setw(17) << t_int << std::setw(13) <<
+                t_packed << std::setw(9) << std::setprecision(1) << t_int / t_packed << "x\n" << std::setprecision(3);
+        };
+        report("hamdist",
+               milliseconds(iterations, [&] { sink = sink + eccpp::hamdist(a, b); }),
+               milliseconds(iterations, [&] { sink = sink + eccpp::hamdist_packed(pa, pb); }));
+        report("hamweight",
+               milliseconds(iterations, [&] { sink = sink + eccpp::hamweight(a); }),
+               milliseconds(iterations, [&] { sink = sink + eccpp::hamweight_packed(pa); }));
+
+        // 256-bit codewords (polar-dist's N = 256), one against all of them
+        const size_t length = 256;
+        const size_t count = n / length;
+        std::vector<std::vector<int>> codewords(count);
+        for (size_t c = 0; c < count; ++c)
+            codewords[c].assign(a.begin() + c * length, a.begin() + (c + 1) * length);
+        std::vector<size_t> distances(count);
+        report("one-to-many",
+               milliseconds(iterations, [&] {
+                   for (size_t c = 0; c < count; ++c)
+                       distances[c] = eccpp::hamdist(codewords[0], codewords[c]);
+               }),
+               milliseconds(iterations, [&] {
+                   eccpp::hamdist_packed(std::span<const std::uint64_t>(pa.data(), length / 64), pa, distances);
+               }));
+        sink = sink + distances[1];
+    }
+
+    const size_t paths = 8;
+    const size_t elements = n / paths;
+    eccpp::mdarray<float> pm({paths, elements}), llr({paths, elements});
+    std::vector<float> u(paths);
+    for (size_t i = 0; i < n; ++i)
+        llr.data()[i] = float(int(i % 17) - 8) * 0.75f;
+    for (size_t l = 0; l < paths; ++l)
+        u[l] = float(l & 1);
+
+    const double t_copy = milliseconds(iterations, [&] {
+        eccpp::mdarray<float> result = pm;
+        for (size_t l = 0; l < paths; ++l) {
+            const float scale = 2.0f * u[l] - 1.0f;
+            for (size_t m = 0; m < elements; ++m)
+                result.data()[l * elements + m] += std::log(1.0f + std::exp(scale * llr.data()[l * elements + m]));
+        }
+        pm.data()[0] = result.data()[1] * 1e-30f;
+    });
+
+    std::cout << "\n" << paths << " paths x " << elements << " elements\n" <<
+        "mode             copying log(1 + exp), ms   phi_inplace, ms   speedup\n";
+    for (auto [name, mode]: {std::pair{"exact", eccpp::phi_mode::exact}, std::pair{"fast", eccpp::phi_mode::fast},
+                             std::pair{"approx_minstar", eccpp::phi_mode::approx_minstar}}) {
+        const double t = milliseconds(iterations, [&] { eccpp::phi_inplace(pm, llr, std::span<const float>(u), mode); });
+        std::cout << std::left << std::setw(17) << name << std::right << std::setw(26) << t_copy << std::setw(18) << t <<
+            std::setw(9) << std::setprecision(1) << t_copy / t << "x\n" << std::setprecision(3);
+    }
+}
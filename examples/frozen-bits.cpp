@@ -30,20 +30,16 @@ int main() {
     size_t start_rows_to_print = 8;
     for (size_t N = N_START; N <= N_END; N *= 2) {
         std::cout << "\n\nN = " << N << "\n";
-        const auto gn = eccpp::gn(N);
+        // G_n is never materialised, which would take 4 GiB at N = 32768
+        const eccpp::gn_view gn(N);
 
         if (N < 32)
-            std::cout << "\nGen matrix:\n" << gn << "\n";
+            std::cout << "\nGen matrix:\n" << gn.to_mdarray() << "\n";
 
         std::vector<row> rows;
         rows.reserve(N);
-        for (size_t r = 0; r < N; ++r) {
-            int num_ones = 0;
-            for (size_t c = 0; c < N; ++c)
-                num_ones += gn({r, c});
-
-            rows.push_back({r, num_ones});
-        }
+        for (size_t r = 0; r < N; ++r)
+            rows.push_back({r, int(gn.row_weight(r))});
 
         std::sort(rows.begin(), rows.end(), [](const row& a, const row& b) {
             if (a.one_cnt == b.one_cnt)
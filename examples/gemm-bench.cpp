@@ -0,0 +1,64 @@
+// 2D mdarray<float> product: blocked GEMM path vs the generic tensor contraction path
+// (the latter is forced by adding a leading unit dimension to lhs)
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <sstream>
+#include <algorithm>
+
+#include "mdarray.h"
+
+static eccpp::mdarray<float> randomMatrix(std::vector<size_t> dims) {
+    eccpp::mdarray<float> m(dims);
+    const size_t rows = dims.end()[-2];
+    const size_t cols = dims.back();
+    for (size_t i = 0; i < rows; ++i)
+        for (size_t j = 0; j < cols; ++j) {
+            std::vector<size_t> idx(dims.size() - 2, 0);
+            idx.push_back(i);
+            idx.push_back(j);
+            m(idx) = float((i * 31 + j * 17) % 23) / 23;
+        }
+    return m;
+}
+
+template <typename Fn>
+static double seconds(Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+}
+
+int main() {
+    const size_t hw_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::cout << "\nfloat matrix product, GFLOP/s (" << hw_threads << " threads for matmul):\n" <<
+                 "-------------------------------------------------\n" <<
+                 "     N |  generic |   blocked | blocked, threads\n" <<
+                 "-------------------------------------------------\n";
+
+    for (size_t n: {128, 256, 512, 1024, 2048}) {
+        const auto a = randomMatrix({n, n});
+        const auto b = randomMatrix({n, n});
+        const double flop = 2.0 * n * n * n;
+
+        // the generic path takes minutes at 1024, skip it for large sizes
+        std::string generic = "-";
+        if (n <= 256) {
+            const auto a3 = randomMatrix({1, n, n});
+            const auto t = seconds([&] { auto c = a3 * b; });
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(2) << flop / t * 1e-9;
+            generic = oss.str();
+        }
+
+        const auto t_blocked = seconds([&] { auto c = a * b; });
+        const auto t_threads = seconds([&] { auto c = matmul(a, b, hw_threads); });
+
+        std::cout << std::fixed << std::setprecision(2) << std::setw(6) << n << " | " << std::setw(8) << generic << " | " <<
+            std::setw(9) << flop / t_blocked * 1e-9 << " | " << std::setw(9) << flop / t_threads * 1e-9 << "\n";
+    }
+}
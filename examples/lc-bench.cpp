@@ -0,0 +1,47 @@
+// lc_run / lc_subseq: the scalar DP against the bit-parallel versions, on random binary and
+// 4-symbol sequences of n = m = 8192
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+
+#include "longest-common.h"
+
+template <typename Fn>
+static double milliseconds(Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    fn();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int main() {
+    const size_t n = 8192;
+    std::mt19937 rng(1);
+
+    std::cout << std::fixed << std::setprecision(2) << "n = m = " << n <<
+        "\nalphabet   function    scalar, ms   bit-parallel, ms   speedup\n";
+    for (unsigned alphabet: {2u, 4u}) {
+        std::vector<int> a(n), b(n);
+        for (auto& x: a)
+            x = int(rng() % alphabet);
+        for (auto& x: b)
+            x = int(rng() % alphabet);
+
+        size_t scalar_result = 0, bitparallel_result = 0;
+        auto report = [&](const char* name, double t_scalar, double t_bitparallel) {
+            std::cout << std::setw(8) << alphabet << "   " << std::left << std::setw(10) << name << std::right <<
+                std::setw(12) << t_scalar << std::setw(19) << t_bitparallel << std::setw(9) << std::setprecision(1) <<
+                t_scalar / t_bitparallel << "x" << (scalar_result == bitparallel_result ? "" : "   MISMATCH") << "\n" <<
+                std::setprecision(2);
+        };
+
+        report("lc_run",
+               milliseconds([&] { scalar_result = eccpp::lc_run(a, b); }),
+               milliseconds([&] { bitparallel_result = eccpp::lc_run_bitparallel(a, b); }));
+        report("lc_subseq",
+               milliseconds([&] { scalar_result = eccpp::lc_subseq(a, b); }),
+               milliseconds([&] { bitparallel_result = eccpp::lc_subseq_bitparallel(a, b); }));
+    }
+}
@@ -0,0 +1,95 @@
+// LDPC over BPSK/AWGN: frame error rate and decoding speed of the layered decoder for every
+// minstar_mode, one frame at a time and ldpc_dec::max_lanes frames at a time
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <cmath>
+
+#include "ldpc-enc.h"
+#include "ldpc-dec.h"
+
+static const struct {
+    size_t frames = 320;        // per Eb/N0 point
+    size_t max_iterations = 20;
+    float ebn0_start = 1.0f;
+    float ebn0_end = 3.0f;
+    float ebn0_step = 0.5f;
+} params;
+
+// rate 1/2, n = 648 (z = 27) in the 802.11n layout
+static eccpp::qc_ldpc_code wifi_code() {
+    const std::vector<int> base = {
+         0, -1, -1, -1,  0,  0, -1, -1,  0, -1, -1,  0,  1,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        22,  0, -1, -1, 17, -1,  0,  0, 12, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+         6, -1,  0, -1, 10, -1, -1, -1, 24, -1,  0, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1, -1, -1, -1,
+         2, -1, -1,  0, 20, -1, -1, -1, 25,  0, -1, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1, -1, -1,
+        23, -1, -1, -1,  3, -1, -1, -1,  0, -1,  9, 11, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1, -1,
+        24, -1, 23,  1, 17, -1,  3, -1, 10, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1,
+        25, -1, -1, -1,  8, -1, -1, -1,  7, 18, -1, -1,  0, -1, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1,
+        13, 24, -1, -1,  0, -1,  8, -1,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0, -1, -1, -1,
+         7, 20, -1, 16, 22, 10, -1, -1, 23, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0, -1, -1,
+        11, -1, -1, -1, 19, -1, -1, -1, 13, -1,  3, 17, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0, -1,
+        25, -1,  8, -1, 23, 18, -1, 14,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0,
+         3, -1, -1, -1, 16, -1, -1,  2, 25,  5, -1, -1,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,
+    };
+    return eccpp::qc_ldpc_code(eccpp::mdarray<int>({12, 24}, base), 27);
+}
+
+int main() {
+    const auto code = wifi_code();
+    eccpp::ldpc_enc enc(code);
+    const float rate = float(code.k()) / float(code.n());
+
+    std::cout << "\nQC-LDPC n = " << code.n() << ", k = " << code.k() << ", " << params.frames <<
+        " frames per point, up to " << params.max_iterations << " iterations\n";
+
+    for (auto [name, mode]: {std::pair{"exact", eccpp::minstar_mode::exact},
+                             std::pair{"jacobian_lut", eccpp::minstar_mode::jacobian_lut},
+                             std::pair{"offset_min_sum", eccpp::minstar_mode::offset_min_sum},
+                             std::pair{"normalized_min_sum", eccpp::minstar_mode::normalized_min_sum}}) {
+        eccpp::ldpc_dec<float> dec(code, params.max_iterations, {mode, 0.5f, 0.75f});
+        std::cout << "\n# " << name << "\nEb/N0, dB   FER      avg iter   single, us/frame   batch, us/frame\n";
+
+        for (float ebn0 = params.ebn0_start; ebn0 <= params.ebn0_end + 1e-3f; ebn0 += params.ebn0_step) {
+            const float sigma = std::sqrt(1 / (2 * rate * std::pow(10.0f, ebn0 / 10)));
+
+            // same seed for every mode, so they see the same noise
+            std::mt19937 rng(12345);
+            std::normal_distribution<float> noise(0.0f, sigma);
+            std::vector<std::vector<int>> msgs(params.frames);
+            std::vector<std::vector<float>> llrs(params.frames);
+            for (size_t f = 0; f < params.frames; ++f) {
+                msgs[f].resize(code.k());
+                for (auto& b: msgs[f])
+                    b = int(rng() & 1);
+
+                const auto codeword = enc.encode(msgs[f]);
+                llrs[f].resize(code.n());
+                for (size_t i = 0; i < code.n(); ++i)
+                    llrs[f][i] = 2 * ((codeword[i] ? -1.0f : 1.0f) + noise(rng)) / (sigma * sigma);
+            }
+
+            size_t errors = 0, iterations = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (size_t f = 0; f < params.frames; ++f) {
+                const auto result = dec.decode(llrs[f]);
+                errors += result.msg != msgs[f];
+                iterations += result.iterations;
+            }
+            auto end = std::chrono::steady_clock::now();
+            const double single = std::chrono::duration<double, std::micro>(end - start).count() / params.frames;
+
+            start = std::chrono::steady_clock::now();
+            const auto results = dec.decode(llrs);
+            end = std::chrono::steady_clock::now();
+            const double batch = std::chrono::duration<double, std::micro>(end - start).count() / params.frames;
+
+            std::cout << std::fixed << std::setprecision(1) << std::setw(9) << ebn0 << std::setprecision(4) <<
+                std::setw(8) << double(errors) / params.frames << std::setprecision(2) << std::setw(11) <<
+                double(iterations) / params.frames << std::setprecision(1) << std::setw(19) << single <<
+                std::setw(18) << batch << "\n";
+        }
+    }
+}
@@ -0,0 +1,103 @@
+// batched min-star: speed and accuracy of every minstar_mode against the scalar eccpp::minstar,
+// on float LLRs drawn from N(2, 2^2) like a BPSK/AWGN channel at a moderate SNR. Errors are
+// against a double exact reference; the min-sum modes use offset 0.5 and scale 0.75
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cmath>
+
+#include "minstar.h"
+
+template <typename Fn>
+static double nanoseconds_per(size_t count, int iterations, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        fn();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations / count;
+}
+
+int main() {
+    // small enough to stay in L2, so it's the kernels that get measured rather than DRAM
+    const size_t n = size_t(1) << 14;
+    const size_t degree = 8;        // check node degree for the extrinsic update
+    const int iterations = 2000;
+
+    std::mt19937 rng(1);
+    std::normal_distribution<float> llr(2.0f, 2.0f);
+    std::vector<float> a(n), b(n), out(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = llr(rng);
+        b[i] = llr(rng);
+    }
+
+    // double references
+    std::vector<double> pair_ref(n), row_ref(n);
+    {
+        std::vector<double> ad(a.begin(), a.end()), bd(b.begin(), b.end());
+        eccpp::minstar<double>(ad, bd, pair_ref, {eccpp::minstar_mode::exact});
+        for (size_t r = 0; r < n; r += degree)
+            eccpp::minstar_extrinsic<double>(std::span<const double>(ad).subspan(r, degree), std::span<double>(row_ref).subspan(r, degree));
+    }
+
+    auto errors = [&](const std::vector<double>& ref) {
+        double sum = 0, worst = 0;
+        for (size_t i = 0; i < n; ++i) {
+            const double e = std::abs(double(out[i]) - ref[i]);
+            sum += e;
+            worst = std::max(worst, e);
+        }
+        return std::pair{sum / n, worst};
+    };
+
+    volatile float sink = 0;
+    std::cout << std::fixed << std::setprecision(2) << "\n" << n << " float pairs, check node degree " << degree << "\n" <<
+        "mode                  pairwise, ns   mean err   max err   extrinsic, ns/edge   mean err   max err\n";
+
+    auto report = [&](const char* name, double t_pair, std::pair<double, double> e_pair, double t_row, std::pair<double, double> e_row) {
+        std::cout << std::left << std::setw(22) << name << std::right << std::setw(12) << t_pair <<
+            std::setprecision(4) << std::setw(11) << e_pair.first << std::setw(10) << e_pair.second << std::setprecision(2);
+        if (t_row > 0)
+            std::cout << std::setw(21) << t_row << std::setprecision(4) << std::setw(11) << e_row.first <<
+                std::setw(10) << e_row.second << std::setprecision(2);
+        std::cout << "\n";
+    };
+
+    for (bool approx: {false, true}) {
+        const double t = nanoseconds_per(n, iterations, [&] {
+            for (size_t i = 0; i < n; ++i)
+                out[i] = eccpp::minstar(a[i], b[i], approx);
+            sink = sink + out[1];
+        });
+        report(approx ? "scalar minstar, approx" : "scalar minstar, exact", t, errors(pair_ref), 0, {});
+    }
+
+    // called through a pointer so the kernel is compiled as it would be for a library caller,
+    // rather than inlined into (and unswitched with) the benchmark loop
+    void (* volatile pairwise)(std::span<const float>, std::span<const float>, std::span<float>, const eccpp::minstar_config<float>&) = eccpp::minstar<float>;
+
+    for (auto [name, mode]: {std::pair{"exact", eccpp::minstar_mode::exact},
+                             std::pair{"jacobian_lut", eccpp::minstar_mode::jacobian_lut},
+                             std::pair{"offset_min_sum", eccpp::minstar_mode::offset_min_sum},
+                             std::pair{"normalized_min_sum", eccpp::minstar_mode::normalized_min_sum}}) {
+        const eccpp::minstar_config<float> config{mode, 0.5f, 0.75f};
+
+        const double t_pair = nanoseconds_per(n, iterations, [&] {
+            pairwise(a, b, out, config);
+            sink = sink + out[1];
+        });
+        const auto e_pair = errors(pair_ref);
+
+        const double t_row = nanoseconds_per(n, iterations, [&] {
+            for (size_t r = 0; r < n; r += degree)
+                eccpp::minstar_extrinsic<float>(std::span<const float>(a).subspan(r, degree), std::span<float>(out).subspan(r, degree), config);
+            sink = sink + out[1];
+        });
+        const auto e_row = errors(row_ref);
+
+        report(name, t_pair, e_pair, t_row, e_row);
+    }
+}
@@ -0,0 +1,105 @@
+// polar codes over BPSK/AWGN with the belief propagation decoder: frame error rate, iterations and
+// decoding speed for both schedules and every minstar_mode
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include "polar-enc.h"
+#include "polar-dec.h"
+
+static const struct {
+    size_t N = 1024;
+    size_t k = 512;
+    size_t frames = 100;        // per Eb/N0 point
+    size_t max_iterations = 60;
+    float ebn0_start = 1.0f;
+    float ebn0_end = 3.0f;
+    float ebn0_step = 0.5f;
+} params;
+
+// Bhattacharyya parameters of the bit channels, as on a BEC with erasure probability z: a 2x2
+// element turns two z channels into a worse 2z - z^2 one (u_i ^ u_{i + step}, the lower index in
+// polar_enc_butterfly) and a better z^2 one. The k smallest carry the message
+static std::vector<size_t> reliable_bits(size_t n, size_t k, double z) {
+    std::vector<double> bhattacharyya{z};
+    while (bhattacharyya.size() < n) {
+        std::vector<double> next(bhattacharyya.size() * 2);
+        for (size_t i = 0; i < bhattacharyya.size(); ++i) {
+            const double v = bhattacharyya[i];
+            next[i] = 2 * v - v * v;
+            next[i + bhattacharyya.size()] = v * v;
+        }
+        bhattacharyya = std::move(next);
+    }
+
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return bhattacharyya[a] < bhattacharyya[b];
+    });
+    order.resize(k);
+    std::sort(order.begin(), order.end());
+    return order;
+}
+
+int main() {
+    eccpp::polar_enc_butterfly enc(params.N);
+    const float rate = float(params.k) / float(params.N);
+
+    // designed for the middle of the Eb/N0 range, z = exp(-Es/N0) on AWGN
+    const float design_ebn0 = (params.ebn0_start + params.ebn0_end) / 2;
+    const auto info_bits = reliable_bits(params.N, params.k, std::exp(-rate * std::pow(10.0, design_ebn0 / 10)));
+
+    std::cout << "\nPolar BP N = " << params.N << ", k = " << params.k << ", " << params.frames <<
+        " frames per point, up to " << params.max_iterations << " iterations\n";
+
+    for (auto [schedule_name, schedule]: {std::pair{"round_trip", eccpp::polar_bp_schedule::round_trip},
+                                          std::pair{"flooding", eccpp::polar_bp_schedule::flooding}})
+        for (auto [name, mode]: {std::pair{"exact", eccpp::minstar_mode::exact},
+                                 std::pair{"jacobian_lut", eccpp::minstar_mode::jacobian_lut},
+                                 std::pair{"offset_min_sum", eccpp::minstar_mode::offset_min_sum},
+                                 std::pair{"normalized_min_sum", eccpp::minstar_mode::normalized_min_sum}}) {
+            eccpp::polar_dec_bp<float> dec(params.N, 0, params.max_iterations, schedule, {mode, 0.25f, 0.9375f});
+            std::cout << "\n# " << schedule_name << ", " << name << "\nEb/N0, dB   FER      avg iter   us/frame\n";
+
+            for (float ebn0 = params.ebn0_start; ebn0 <= params.ebn0_end + 1e-3f; ebn0 += params.ebn0_step) {
+                const float sigma = std::sqrt(1 / (2 * rate * std::pow(10.0f, ebn0 / 10)));
+
+                // same seed for every decoder, so they see the same noise
+                std::mt19937 rng(12345);
+                std::normal_distribution<float> noise(0.0f, sigma);
+                std::vector<std::vector<int>> msgs(params.frames);
+                std::vector<std::vector<float>> llrs(params.frames);
+                for (size_t f = 0; f < params.frames; ++f) {
+                    std::vector<int> u(params.N);
+                    msgs[f].resize(params.k);
+                    for (size_t i = 0; i < params.k; ++i)
+                        u[info_bits[i]] = msgs[f][i] = int(rng() & 1);
+
+                    const auto codeword = enc.encode(u);
+                    llrs[f].resize(params.N);
+                    for (size_t i = 0; i < params.N; ++i)
+                        llrs[f][i] = 2 * ((codeword[i] ? -1.0f : 1.0f) + noise(rng)) / (sigma * sigma);
+                }
+
+                size_t errors = 0, iterations = 0;
+                const auto start = std::chrono::steady_clock::now();
+                for (size_t f = 0; f < params.frames; ++f) {
+                    const auto result = dec.decode(llrs[f], info_bits);
+                    errors += result.msg != msgs[f];
+                    iterations += result.iterations;
+                }
+                const auto end = std::chrono::steady_clock::now();
+                const double us = std::chrono::duration<double, std::micro>(end - start).count() / params.frames;
+
+                std::cout << std::fixed << std::setprecision(1) << std::setw(9) << ebn0 << std::setprecision(4) <<
+                    std::setw(8) << double(errors) / params.frames << std::setprecision(2) << std::setw(11) <<
+                    double(iterations) / params.frames << std::setprecision(1) << std::setw(11) << us << "\n";
+            }
+        }
+}
@@ -1,5 +1,6 @@
 // Generate codewords for all possible information bit combinations
-// and calculate the minimum Hamming distance
+// and calculate the minimum Hamming distance (from the weight spectrum, see code-analysis.h)
+// and the longest common run between any two codewords
 
 #include <iostream>
 #include <iomanip>
@@ -10,8 +11,7 @@
 
 #include "gn.h"
 #include "polar-enc.h"
-#include "hamdist.h"
-#include "hamweight.h"
+#include "code-analysis.h"
 #include "longest-common.h"
 #include "shuffle.h"
 
@@ -62,45 +62,46 @@ int main() {
     std::uint_fast32_t shuffle_seed = 3;
     size_t best_max_lc_run = N + 1;
     for (int iter = 0; iter < num_iter; ++iter) {
-        size_t min_dist = N + 1;
         size_t max_lc_run = 0;
 
         std::vector<int> msg(N);
         const size_t codeword_count = 1 << info_bits.size();
-        std::vector<std::vector<int>> codewords;
-        codewords.reserve(codeword_count);
+        const size_t codeword_words = eccpp::packed_words(N);
+
+        // packed codewords back to back, each new one is checked against all of them at once
+        std::vector<std::uint64_t> codewords;
+        codewords.reserve(codeword_count * codeword_words);
+        size_t generated = 0;
 
         std::cout << "\n--- " << (iter + 1) << "/" << num_iter << ": " << (iter ? "Shuffled" : "Original") << " polar codes -----------------------------\n\n";
         if (iter) {
             shuffle_seed = shuffle_seed * 3 + 11;
             std::cout << "Shuffle seed: " << shuffle_seed << "\n";
         }
+
+        // for a linear code the minimum distance is the minimum nonzero weight, no pairs needed:
+        // https://www.ece.unb.ca/cgi-bin/tervo/polygen2.pl (scroll down to Distance Analysis)
+        const auto spectrum_start = std::chrono::steady_clock::now();
+        const auto spectrum = eccpp::weight_enumerator(eccpp::execution::par,
+            eccpp::polar_generator(N, info_bits, iter ? shuffle_seed : 0));
+        const auto spectrum_end = std::chrono::steady_clock::now();
+        if (spectrum.weights[0] != 1)
+            throw std::runtime_error("Hamming distance is 0 - identical codewords");
+
+        std::cout << "Weight spectrum in " << chronoToHms(std::chrono::duration_cast<std::chrono::milliseconds>(spectrum_end - spectrum_start)) <<
+            ": minimum distance " << spectrum.min_distance << " x " << spectrum.multiplicity << "\n";
+
         std::cout << "Generating codewords, might take a while...\n\n";
         const auto start = std::chrono::steady_clock::now();
-        while (codewords.size() < codeword_count) {
+        while (generated < codeword_count) {
             auto codeword = enc.encode(msg);
             if (iter)
                 eccpp::shuffle(codeword, shuffle_seed);
 
-            // apparently, for linear block codes you can just use Hamming weight instead
-            // of exhaustive search: https://www.ece.unb.ca/cgi-bin/tervo/polygen2.pl
-            // (scroll down to Distance Analysis):
-            //const auto cw_weight = eccpp::hamweight(codeword);
-            //if (cw_weight > 0)
-            //    min_dist = std::min(min_dist, cw_weight);
-            // however, we also do LCR search, so it doesn't really matter
-
-            for (const auto& cw: codewords) {
-                const auto dist = eccpp::hamdist(cw, codeword);
-                if (dist == 0)
-                    throw std::runtime_error("Hamming distance is 0 - identical codewords");
-
-                min_dist = std::min(min_dist, dist);
-
-                const auto lcr = eccpp::lc_aligned_run<int, size_t>(cw, codeword);
-                max_lc_run = std::max(max_lc_run, lcr);
-            }
-            codewords.push_back(codeword);
+            const auto packed = eccpp::pack_bits(codeword);
+            max_lc_run = std::max(max_lc_run, eccpp::lc_aligned_run_packed_max(packed, codewords, N));
+            codewords.insert(codewords.end(), packed.begin(), packed.end());
+            ++generated;
 
             // increment message
             for (size_t i = 0; i < info_bits.size(); ++i) {
@@ -115,13 +116,13 @@ int main() {
                 }
             }
 
-            std::cout << "\rProcessed " << codewords.size() << " of " << codeword_count << " codewords (min dist: " << min_dist << ")     ";
+            std::cout << "\rProcessed " << generated << " of " << codeword_count << " codewords (longest common run: " << max_lc_run << ")     ";
         }
         const auto end = std::chrono::steady_clock::now();
         const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
         std::cout << "\n\nDone in " << chronoToHms(elapsed) << "\n";
 
-        std::cout << "\nMinimum Hamming distance:     " << min_dist << "\n";
+        std::cout << "\nMinimum Hamming distance:     " << spectrum.min_distance << "\n";
         std::cout << "Longest common run:           " << max_lc_run << "\n";
         std::cout << "Minimum repeat code distance: " << N / info_bits.size() << "\n";
 
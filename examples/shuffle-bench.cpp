@@ -0,0 +1,56 @@
+// shuffle()/unshuffle() vs precomputed shuffle_perm for sizes ranging from L2-resident
+// to DRAM-resident, both for int codewords and float LLRs
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <functional>
+#include <algorithm>
+
+#include "shuffle.h"
+
+constexpr std::uint_fast32_t seed = 12345;
+
+template<typename T>
+double nsPerElement(size_t n, int iterations, const std::function<void(std::vector<T>&)>& fn) {
+    std::vector<T> data(n);
+    for (size_t i = 0; i < n; ++i)
+        data[i] = static_cast<T>(i & 1);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        fn(data);
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / (double(n) * iterations);
+}
+
+template<typename T>
+void bench(const char* type_name) {
+    std::cout << "\n" << type_name << ", ns per element:\n" <<
+                 "-----------------------------------------------------------------------\n" <<
+                 "       N |  shuffle | unshuffle |  perm.shuffle | perm.unshuffle | x\n" <<
+                 "-----------------------------------------------------------------------\n";
+
+    for (size_t n = 1 << 14; n <= (1 << 22); n *= 4) {
+        const int iterations = std::max<int>(1, (1 << 24) / n);
+        const eccpp::shuffle_perm perm(n, seed);
+        std::vector<T> out(n);
+
+        const auto t_shuffle = nsPerElement<T>(n, iterations, [](auto& v) { eccpp::shuffle(v, seed); });
+        const auto t_unshuffle = nsPerElement<T>(n, iterations, [](auto& v) { eccpp::unshuffle(v, seed); });
+        const auto t_perm_shuffle = nsPerElement<T>(n, iterations, [&](auto& v) { perm.shuffle(v, out); });
+        const auto t_perm_unshuffle = nsPerElement<T>(n, iterations, [&](auto& v) { perm.unshuffle(out, v); });
+
+        std::cout << std::fixed << std::setprecision(2) <<
+            std::setw(8) << n << " | " << std::setw(8) << t_shuffle << " | " << std::setw(9) << t_unshuffle << " | " <<
+            std::setw(13) << t_perm_shuffle << " | " << std::setw(14) << t_perm_unshuffle << " | " <<
+            std::setprecision(1) << t_shuffle / t_perm_shuffle << "\n";
+    }
+}
+
+int main() {
+    bench<int>("int codewords");
+    bench<float>("float LLRs");
+}
@@ -0,0 +1,163 @@
+// execution policies for mdarray element-wise operations and reductions, in the spirit of
+// std::execution (which isn't available everywhere, and gives no reproducibility guarantees):
+// * seq       - plain loop, one thread;
+// * unseq     - one thread, loops marked as free of dependencies so the compiler vectorises them;
+// * par       - the work is split into contiguous ranges processed by separate threads,
+//               par(n) limits the number of threads;
+// * par_unseq - both of the above.
+// Reductions always use the same fixed tree: the data is split into reduction_block elements
+// long blocks, each block is accumulated into 8 interleaved lanes, and the per-block results are
+// combined pairwise. Threads only ever get whole blocks, so every policy and thread count gives
+// bit-identical results, including floating-point sums.
+
+#ifndef ECCPP_EXECUTION_H
+#define ECCPP_EXECUTION_H
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <type_traits>
+#include <cstddef>
+
+#if defined(__clang__)
+#define ECCPP_SIMD_LOOP _Pragma("clang loop vectorize(enable) interleave(enable)")
+#elif defined(__GNUC__)
+#define ECCPP_SIMD_LOOP _Pragma("GCC ivdep")
+#elif defined(_MSC_VER)
+#define ECCPP_SIMD_LOOP __pragma(loop(ivdep))
+#else
+#define ECCPP_SIMD_LOOP
+#endif
+
+namespace eccpp {
+
+namespace execution {
+
+struct sequenced_policy {};
+struct unsequenced_policy {};
+
+struct parallel_policy {
+    size_t threads = 0;     // 0 - all hardware threads
+
+    parallel_policy operator()(size_t n) const { return {n}; }
+};
+
+struct parallel_unsequenced_policy {
+    size_t threads = 0;
+
+    parallel_unsequenced_policy operator()(size_t n) const { return {n}; }
+};
+
+inline constexpr sequenced_policy seq{};
+inline constexpr unsequenced_policy unseq{};
+inline constexpr parallel_policy par{};
+inline constexpr parallel_unsequenced_policy par_unseq{};
+
+} // namespace execution
+
+template <typename P>
+concept execution_policy = std::is_same_v<P, execution::sequenced_policy> ||
+                           std::is_same_v<P, execution::unsequenced_policy> ||
+                           std::is_same_v<P, execution::parallel_policy> ||
+                           std::is_same_v<P, execution::parallel_unsequenced_policy>;
+
+template <typename P>
+inline constexpr bool is_unsequenced_policy_v = std::is_same_v<P, execution::unsequenced_policy> ||
+                                                std::is_same_v<P, execution::parallel_unsequenced_policy>;
+
+template <typename P>
+inline constexpr bool is_parallel_policy_v = std::is_same_v<P, execution::parallel_policy> ||
+                                             std::is_same_v<P, execution::parallel_unsequenced_policy>;
+
+namespace detail {
+
+inline constexpr size_t reduction_block = 2048;
+
+// below this many elements per thread spawning threads costs more than it saves
+inline constexpr size_t min_parallel_elements = size_t(1) << 15;
+
+// calls fn(begin, end) over [0, n) for items that aren't single elements (rows, say): ranges are
+// multiples of grain items except for the last one, with a thread per min_items at most
+template <execution_policy P, typename Fn>
+void for_each_range(P policy, size_t n, size_t grain, size_t min_items, Fn fn) {
+    size_t threads = 1;
+    if constexpr (is_parallel_policy_v<P>) {
+        threads = policy.threads ? policy.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = std::min(threads, (n + min_items - 1) / std::max<size_t>(1, min_items));
+    }
+
+    if (threads <= 1) {
+        fn(size_t(0), n);
+        return;
+    }
+
+    const size_t blocks = (n + grain - 1) / grain;
+    const size_t blocks_per_thread = (blocks + threads - 1) / threads;
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (size_t t = 1; t < threads; ++t) {
+        const size_t begin = std::min(n, t * blocks_per_thread * grain);
+        const size_t end = std::min(n, begin + blocks_per_thread * grain);
+        if (begin < end)
+            workers.emplace_back(fn, begin, end);
+    }
+
+    fn(size_t(0), std::min(n, blocks_per_thread * grain));
+    for (auto& w: workers)
+        w.join();
+}
+
+// calls fn(begin, end) over [0, n) elements, ranges are multiples of reduction_block except for the
+// last one
+template <execution_policy P, typename Fn>
+void for_each_range(P policy, size_t n, Fn fn) {
+    for_each_range(policy, n, reduction_block, min_parallel_elements, fn);
+}
+
+// leaf(begin, end) reduces a single block, combine merges two partial results
+template <execution_policy P, typename V, typename Leaf, typename Combine>
+V tree_reduce(P policy, size_t n, Leaf leaf, Combine combine) {
+    std::vector<V> partial((n + reduction_block - 1) / reduction_block);
+
+    for_each_range(policy, n, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b += reduction_block)
+            partial[b / reduction_block] = leaf(b, std::min(end, b + reduction_block));
+    });
+
+    for (size_t width = 1; width < partial.size(); width *= 2)
+        for (size_t i = 0; i + width < partial.size(); i += 2 * width)
+            partial[i] = combine(partial[i], partial[i + width]);
+
+    return partial[0];
+}
+
+// sum of f(data[i]) over a block in 8 interleaved lanes, combined pairwise
+template <bool Unsequenced, typename T, typename F>
+T lane_sum(const T* data, size_t n, F f) {
+    constexpr size_t lanes = 8;
+    T acc[lanes] = {};
+
+    size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        if constexpr (Unsequenced) {
+            ECCPP_SIMD_LOOP
+            for (size_t j = 0; j < lanes; ++j)
+                acc[j] += f(data[i + j]);
+        }
+        else {
+            for (size_t j = 0; j < lanes; ++j)
+                acc[j] += f(data[i + j]);
+        }
+    }
+    for (size_t j = 0; i < n; ++i, ++j)
+        acc[j] += f(data[i]);
+
+    return ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+}
+
+} // namespace detail
+
+} // namespace eccpp
+
+#endif // ECCPP_EXECUTION_H
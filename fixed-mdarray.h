@@ -0,0 +1,134 @@
+// mdarray with the rank known at compile time: dimensions and strides live in std::arrays and
+// elements are accessed with arr(i, j, ...) - no index vector gets allocated per access.
+// operator() is unchecked (asserts only), at() validates the indices and throws.
+// Converting from/to the dynamic-rank mdarray moves the data buffer instead of copying it.
+
+#ifndef ECCPP_FIXED_MDARRAY_H
+#define ECCPP_FIXED_MDARRAY_H
+
+#include <array>
+#include <vector>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+#include "mdarray.h"
+
+namespace eccpp {
+
+template <typename T, size_t Rank>
+class fixed_mdarray {
+    static_assert(Rank > 0, "fixed_mdarray rank must be positive");
+
+    std::array<size_t, Rank> dims_;
+    std::array<size_t, Rank> index_stride_;
+    std::vector<T, aligned_allocator<T>> data_;
+
+public:
+    fixed_mdarray(const std::array<size_t, Rank>& dims): dims_(dims) {
+        data_.resize(init_strides());
+    }
+
+    template <typename A>
+    explicit fixed_mdarray(const mdarray<T, A>& other): fixed_mdarray(to_dims(other.dimensions())) {
+        std::copy(other.data(), other.data() + other.size(), data_.begin());
+    }
+
+    explicit fixed_mdarray(mdarray<T>&& other): dims_(to_dims(other.dimensions())) {
+        init_strides();
+        data_ = std::move(other).release();
+    }
+
+    // copy into a dynamic-rank mdarray
+    mdarray<T> to_mdarray() const& {
+        return mdarray<T>(std::vector<size_t>(dims_.begin(), dims_.end()), std::vector<T, aligned_allocator<T>>(data_));
+    }
+
+    // move the buffer into a dynamic-rank mdarray
+    mdarray<T> to_mdarray() && {
+        return mdarray<T>(std::vector<size_t>(dims_.begin(), dims_.end()), std::move(data_));
+    }
+
+    static constexpr size_t rank() { return Rank; }
+    const std::array<size_t, Rank>& dimensions() const { return dims_; }
+    size_t size() const { return data_.size(); }
+    T* data() { return data_.data(); }
+    const T* data() const { return data_.data(); }
+
+    template <typename... Idx>
+    T& operator()(Idx... indices) {
+        return data_[offset(indices...)];
+    }
+
+    template <typename... Idx>
+    const T& operator()(Idx... indices) const {
+        return data_[offset(indices...)];
+    }
+
+    template <typename... Idx>
+    T& at(Idx... indices) {
+        return data_[checked_offset(indices...)];
+    }
+
+    template <typename... Idx>
+    const T& at(Idx... indices) const {
+        return data_[checked_offset(indices...)];
+    }
+
+    friend bool operator==(const fixed_mdarray& lhs, const fixed_mdarray& rhs) {
+        return (lhs.dims_ == rhs.dims_) && (lhs.data_ == rhs.data_);
+    }
+    friend bool operator!=(const fixed_mdarray& lhs, const fixed_mdarray& rhs) {
+        return !(lhs == rhs);
+    }
+
+private:
+    static std::array<size_t, Rank> to_dims(const std::vector<size_t>& dims) {
+        if (dims.size() != Rank)
+            throw std::invalid_argument("Number of dimensions does not match fixed rank");
+
+        std::array<size_t, Rank> result{};
+        std::copy(dims.begin(), dims.end(), result.begin());
+        return result;
+    }
+
+    size_t init_strides() {
+        size_t total = detail::mdarray_total_size(dims_);
+        const size_t result = total;
+
+        for (size_t i = 0; i < Rank; ++i) {
+            total /= dims_[i];
+            index_stride_[i] = total;
+        }
+        return result;
+    }
+
+    template <typename... Idx>
+    size_t offset(Idx... indices) const {
+        static_assert(sizeof...(Idx) == Rank, "Number of indices does not match rank");
+
+        const std::array<size_t, Rank> idx = {size_t(indices)...};
+        size_t off = 0;
+        for (size_t i = 0; i < Rank; ++i) {
+            assert(idx[i] < dims_[i]);
+            off += idx[i] * index_stride_[i];
+        }
+        return off;
+    }
+
+    template <typename... Idx>
+    size_t checked_offset(Idx... indices) const {
+        static_assert(sizeof...(Idx) == Rank, "Number of indices does not match rank");
+
+        const std::array<size_t, Rank> idx = {size_t(indices)...};
+        for (size_t i = 0; i < Rank; ++i)
+            if (idx[i] >= dims_[i])
+                throw std::invalid_argument("Index out of bounds");
+
+        return offset(indices...);
+    }
+};
+
+} // namespace eccpp
+
+#endif // ECCPP_FIXED_MDARRAY_H
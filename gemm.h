@@ -0,0 +1,257 @@
+// cache-blocked general matrix multiplication C += A * B for row-major matrices, following the
+// usual GotoBLAS/BLIS structure: B is packed into kc x nc panels (L3/L2), A into mc x kc blocks (L2),
+// and an mr x nr register tile of C is accumulated by the micro-kernel over kc.
+// The float/double micro-kernels use AVX-512 or AVX2 + FMA when the compiler targets them
+// (e.g. -march=native, see the ECCPP_NATIVE_ARCH CMake option), otherwise a plain C++ kernel
+// is used, which the compiler is still free to auto-vectorise.
+
+#ifndef ECCPP_GEMM_H
+#define ECCPP_GEMM_H
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <cstddef>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace eccpp {
+
+namespace detail {
+
+// generic micro-kernel: acc[mr x nr] = sum over k of a[k][0..mr) x b[k][0..nr)
+template <typename T>
+struct gemm_kernel {
+    static constexpr size_t mr = 4;
+    static constexpr size_t nr = 8;
+
+    static void run(size_t kc, const T* a, const T* b, T* acc) {
+        T c[mr][nr] = {};
+        for (size_t k = 0; k < kc; ++k, a += mr, b += nr)
+            for (size_t i = 0; i < mr; ++i)
+                for (size_t j = 0; j < nr; ++j)
+                    c[i][j] += a[i] * b[j];
+
+        for (size_t i = 0; i < mr; ++i)
+            for (size_t j = 0; j < nr; ++j)
+                acc[i * nr + j] = c[i][j];
+    }
+};
+
+#if defined(__AVX512F__)
+
+template <>
+struct gemm_kernel<float> {
+    static constexpr size_t mr = 6;
+    static constexpr size_t nr = 32;
+
+    static void run(size_t kc, const float* a, const float* b, float* acc) {
+        __m512 c[mr][2];
+        for (size_t i = 0; i < mr; ++i)
+            c[i][0] = c[i][1] = _mm512_setzero_ps();
+
+        for (size_t k = 0; k < kc; ++k, a += mr, b += nr) {
+            const __m512 b0 = _mm512_loadu_ps(b);
+            const __m512 b1 = _mm512_loadu_ps(b + 16);
+            for (size_t i = 0; i < mr; ++i) {
+                const __m512 ai = _mm512_set1_ps(a[i]);
+                c[i][0] = _mm512_fmadd_ps(ai, b0, c[i][0]);
+                c[i][1] = _mm512_fmadd_ps(ai, b1, c[i][1]);
+            }
+        }
+
+        for (size_t i = 0; i < mr; ++i) {
+            _mm512_storeu_ps(acc + i * nr, c[i][0]);
+            _mm512_storeu_ps(acc + i * nr + 16, c[i][1]);
+        }
+    }
+};
+
+template <>
+struct gemm_kernel<double> {
+    static constexpr size_t mr = 6;
+    static constexpr size_t nr = 16;
+
+    static void run(size_t kc, const double* a, const double* b, double* acc) {
+        __m512d c[mr][2];
+        for (size_t i = 0; i < mr; ++i)
+            c[i][0] = c[i][1] = _mm512_setzero_pd();
+
+        for (size_t k = 0; k < kc; ++k, a += mr, b += nr) {
+            const __m512d b0 = _mm512_loadu_pd(b);
+            const __m512d b1 = _mm512_loadu_pd(b + 8);
+            for (size_t i = 0; i < mr; ++i) {
+                const __m512d ai = _mm512_set1_pd(a[i]);
+                c[i][0] = _mm512_fmadd_pd(ai, b0, c[i][0]);
+                c[i][1] = _mm512_fmadd_pd(ai, b1, c[i][1]);
+            }
+        }
+
+        for (size_t i = 0; i < mr; ++i) {
+            _mm512_storeu_pd(acc + i * nr, c[i][0]);
+            _mm512_storeu_pd(acc + i * nr + 8, c[i][1]);
+        }
+    }
+};
+
+#elif defined(__AVX2__) && defined(__FMA__)
+
+template <>
+struct gemm_kernel<float> {
+    static constexpr size_t mr = 6;
+    static constexpr size_t nr = 16;
+
+    static void run(size_t kc, const float* a, const float* b, float* acc) {
+        __m256 c[mr][2];
+        for (size_t i = 0; i < mr; ++i)
+            c[i][0] = c[i][1] = _mm256_setzero_ps();
+
+        for (size_t k = 0; k < kc; ++k, a += mr, b += nr) {
+            const __m256 b0 = _mm256_loadu_ps(b);
+            const __m256 b1 = _mm256_loadu_ps(b + 8);
+            for (size_t i = 0; i < mr; ++i) {
+                const __m256 ai = _mm256_broadcast_ss(a + i);
+                c[i][0] = _mm256_fmadd_ps(ai, b0, c[i][0]);
+                c[i][1] = _mm256_fmadd_ps(ai, b1, c[i][1]);
+            }
+        }
+
+        for (size_t i = 0; i < mr; ++i) {
+            _mm256_storeu_ps(acc + i * nr, c[i][0]);
+            _mm256_storeu_ps(acc + i * nr + 8, c[i][1]);
+        }
+    }
+};
+
+template <>
+struct gemm_kernel<double> {
+    static constexpr size_t mr = 6;
+    static constexpr size_t nr = 8;
+
+    static void run(size_t kc, const double* a, const double* b, double* acc) {
+        __m256d c[mr][2];
+        for (size_t i = 0; i < mr; ++i)
+            c[i][0] = c[i][1] = _mm256_setzero_pd();
+
+        for (size_t k = 0; k < kc; ++k, a += mr, b += nr) {
+            const __m256d b0 = _mm256_loadu_pd(b);
+            const __m256d b1 = _mm256_loadu_pd(b + 4);
+            for (size_t i = 0; i < mr; ++i) {
+                const __m256d ai = _mm256_broadcast_sd(a + i);
+                c[i][0] = _mm256_fmadd_pd(ai, b0, c[i][0]);
+                c[i][1] = _mm256_fmadd_pd(ai, b1, c[i][1]);
+            }
+        }
+
+        for (size_t i = 0; i < mr; ++i) {
+            _mm256_storeu_pd(acc + i * nr, c[i][0]);
+            _mm256_storeu_pd(acc + i * nr + 4, c[i][1]);
+        }
+    }
+};
+
+#endif
+
+// A[mc x kc] -> mr-row strips, each strip stored k-major (zero-padded to a full strip)
+template <typename T, size_t mr>
+void gemm_pack_a(size_t mc, size_t kc, const T* a, size_t lda, T* packed) {
+    for (size_t i = 0; i < mc; i += mr) {
+        const size_t rows = std::min(mr, mc - i);
+        for (size_t k = 0; k < kc; ++k)
+            for (size_t r = 0; r < mr; ++r)
+                *packed++ = r < rows ? a[(i + r) * lda + k] : T();
+    }
+}
+
+// B[kc x nc] -> nr-column strips, each strip stored k-major (zero-padded to a full strip)
+template <typename T, size_t nr>
+void gemm_pack_b(size_t kc, size_t nc, const T* b, size_t ldb, T* packed) {
+    for (size_t j = 0; j < nc; j += nr) {
+        const size_t cols = std::min(nr, nc - j);
+        for (size_t k = 0; k < kc; ++k) {
+            const T* src = b + k * ldb + j;
+            for (size_t c = 0; c < nr; ++c)
+                *packed++ = c < cols ? src[c] : T();
+        }
+    }
+}
+
+} // namespace detail
+
+// C[m x n] += A[m x k] * B[k x n], all row-major with leading dimensions lda/ldb/ldc.
+// Row blocks of C are split across the given number of threads once the product is large enough
+// to pay for spawning them
+template <typename T>
+void gemm(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc, size_t threads = 1) {
+    using kernel = detail::gemm_kernel<T>;
+    constexpr size_t mr = kernel::mr;
+    constexpr size_t nr = kernel::nr;
+
+    // kc x nr strip of B stays in L1, mc x kc block of A in L2, kc x nc panel of B in L3
+    constexpr size_t kc_max = 256;
+    constexpr size_t mc_max = mr * 24;
+    constexpr size_t nc_max = nr * 128;
+
+    if (!m || !n || !k)
+        return;
+
+    const size_t num_mc_blocks = (m + mc_max - 1) / mc_max;
+    if (m * n * k < (size_t(1) << 21))
+        threads = 1;
+    threads = std::max<size_t>(1, std::min(threads, num_mc_blocks));
+
+    std::vector<T> packed_b(kc_max * ((std::min(n, nc_max) + nr - 1) / nr * nr));
+    std::vector<std::vector<T>> packed_a(threads, std::vector<T>((mc_max + mr - 1) / mr * mr * kc_max));
+
+    for (size_t jc = 0; jc < n; jc += nc_max) {
+        const size_t nc = std::min(nc_max, n - jc);
+
+        for (size_t pc = 0; pc < k; pc += kc_max) {
+            const size_t kc = std::min(kc_max, k - pc);
+            detail::gemm_pack_b<T, nr>(kc, nc, b + pc * ldb + jc, ldb, packed_b.data());
+
+            auto process_blocks = [&](size_t first_block, size_t block_step, T* pa) {
+                T acc[mr * nr];
+                for (size_t blk = first_block; blk < num_mc_blocks; blk += block_step) {
+                    const size_t ic = blk * mc_max;
+                    const size_t mc = std::min(mc_max, m - ic);
+                    detail::gemm_pack_a<T, mr>(mc, kc, a + ic * lda + pc, lda, pa);
+
+                    for (size_t jr = 0; jr < nc; jr += nr) {
+                        const size_t cols = std::min(nr, nc - jr);
+                        const T* pb = packed_b.data() + jr * kc;
+
+                        for (size_t ir = 0; ir < mc; ir += mr) {
+                            const size_t rows = std::min(mr, mc - ir);
+                            kernel::run(kc, pa + ir * kc, pb, acc);
+
+                            T* dst = c + (ic + ir) * ldc + jc + jr;
+                            for (size_t i = 0; i < rows; ++i)
+                                for (size_t j = 0; j < cols; ++j)
+                                    dst[i * ldc + j] += acc[i * nr + j];
+                        }
+                    }
+                }
+            };
+
+            if (threads == 1)
+                process_blocks(0, 1, packed_a[0].data());
+            else {
+                std::vector<std::thread> workers;
+                workers.reserve(threads - 1);
+                for (size_t t = 1; t < threads; ++t)
+                    workers.emplace_back(process_blocks, t, threads, packed_a[t].data());
+
+                process_blocks(0, threads, packed_a[0].data());
+                for (auto& w: workers)
+                    w.join();
+            }
+        }
+    }
+}
+
+} // namespace eccpp
+
+#endif // ECCPP_GEMM_H
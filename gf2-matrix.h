@@ -0,0 +1,319 @@
+// dense GF(2) matrix with rows packed into 64-bit words (32x less memory than mdarray<int>),
+// so row additions, products and eliminations are word-parallel XORs.
+// Matrix-matrix product uses the Method of Four Russians (M4RM):
+// https://en.wikipedia.org/wiki/Method_of_Four_Russians
+
+#ifndef ECCPP_GF2_MATRIX_H
+#define ECCPP_GF2_MATRIX_H
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <iostream>
+#include <bit>
+
+#include "bitpack.h"
+#include "mdarray.h"
+
+namespace eccpp {
+
+class gf2_matrix {
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    size_t stride_ = 0;     // words per row
+    std::vector<std::uint64_t> data_;
+
+public:
+    gf2_matrix(size_t rows, size_t cols): rows_(rows), cols_(cols), stride_(packed_words(cols)) {
+        if (!rows || !cols)
+            throw std::invalid_argument("Invalid zero-size dimension");
+
+        if (stride_ > data_.max_size() / rows)
+            throw std::invalid_argument("Dimensions too large");
+
+        data_.resize(rows * stride_);
+    }
+
+    // any non-zero element of a 2D mdarray is treated as 1
+    template <typename T, typename A>
+    explicit gf2_matrix(const mdarray<T, A>& m): gf2_matrix(matrix_rows(m), matrix_cols(m)) {
+        for (size_t r = 0; r < rows_; ++r)
+            for (size_t c = 0; c < cols_; ++c)
+                if (m.dimensions().size() == 1 ? m({c}) : m({r, c}))
+                    set(r, c, 1);
+    }
+
+    static gf2_matrix identity(size_t n) {
+        gf2_matrix result(n, n);
+        for (size_t i = 0; i < n; ++i)
+            result.set(i, i, 1);
+
+        return result;
+    }
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    size_t words_per_row() const { return stride_; }
+
+    int operator()(size_t r, size_t c) const {
+        check_index(r, c);
+        return int((row(r)[c / 64] >> (c % 64)) & 1);
+    }
+
+    void set(size_t r, size_t c, int bit) {
+        check_index(r, c);
+        const auto mask = std::uint64_t(1) << (c % 64);
+        auto& word = row(r)[c / 64];
+        word = bit ? (word | mask) : (word & ~mask);
+    }
+
+    std::uint64_t* row(size_t r) { return data_.data() + r * stride_; }
+    const std::uint64_t* row(size_t r) const { return data_.data() + r * stride_; }
+
+    std::vector<std::uint64_t> packed_row(size_t r) const {
+        if (r >= rows_)
+            throw std::invalid_argument("Index out of bounds");
+
+        return std::vector<std::uint64_t>(row(r), row(r) + stride_);
+    }
+
+    void set_packed_row(size_t r, const std::vector<std::uint64_t>& bits) {
+        if (r >= rows_)
+            throw std::invalid_argument("Index out of bounds");
+        if (bits.size() != stride_)
+            throw std::invalid_argument("Packed row size mismatch");
+
+        std::copy(bits.begin(), bits.end(), row(r));
+        row(r)[stride_ - 1] &= tail_mask();
+    }
+
+    mdarray<int> to_mdarray() const {
+        mdarray<int> result({rows_, cols_});
+        for (size_t r = 0; r < rows_; ++r)
+            for (size_t c = 0; c < cols_; ++c)
+                result({r, c}) = (*this)(r, c);
+
+        return result;
+    }
+
+    friend bool operator==(const gf2_matrix& lhs, const gf2_matrix& rhs) {
+        return lhs.rows_ == rhs.rows_ && lhs.cols_ == rhs.cols_ && lhs.data_ == rhs.data_;
+    }
+    friend bool operator!=(const gf2_matrix& lhs, const gf2_matrix& rhs) {
+        return !(lhs == rhs);
+    }
+
+    // addition and subtraction are the same thing in GF(2)
+    gf2_matrix& operator+=(const gf2_matrix& other) {
+        if (rows_ != other.rows_ || cols_ != other.cols_)
+            throw std::invalid_argument("Dimension mismatch for + or += operation");
+
+        for (size_t i = 0; i < data_.size(); ++i)
+            data_[i] ^= other.data_[i];
+
+        return *this;
+    }
+
+    friend gf2_matrix operator+(const gf2_matrix& lhs, const gf2_matrix& rhs) {
+        gf2_matrix result = lhs;
+        return (result += rhs);
+    }
+
+    // M * v, v is a packed column vector of cols() bits, the result has rows() bits
+    std::vector<std::uint64_t> operator*(const std::vector<std::uint64_t>& v) const {
+        if (v.size() != stride_)
+            throw std::invalid_argument("Dimension mismatch for matrix-vector product");
+
+        std::vector<std::uint64_t> result(packed_words(rows_));
+        for (size_t r = 0; r < rows_; ++r) {
+            const auto* src = row(r);
+            std::uint64_t acc = 0;
+            for (size_t w = 0; w < stride_; ++w)
+                acc ^= src[w] & v[w];
+
+            result[r / 64] |= std::uint64_t(std::popcount(acc) & 1) << (r % 64);
+        }
+        return result;
+    }
+
+    // v * M, v is a packed row vector of rows() bits, the result has cols() bits. A single vector
+    // doesn't amortise the M4RM tables, so this is a plain XOR of the selected rows. Bits of v
+    // past rows() are ignored
+    friend std::vector<std::uint64_t> operator*(const std::vector<std::uint64_t>& v, const gf2_matrix& m) {
+        if (v.size() != packed_words(m.rows_))
+            throw std::invalid_argument("Dimension mismatch for vector-matrix product");
+
+        std::vector<std::uint64_t> result(m.stride_);
+        for (size_t w = 0; w < v.size(); ++w) {
+            const auto used = w + 1 == v.size() ? packed_tail_mask(m.rows_) : ~std::uint64_t(0);
+            for (auto bits = v[w] & used; bits; bits &= bits - 1) {
+                const auto* src = m.row(w * 64 + std::countr_zero(bits));
+                for (size_t i = 0; i < m.stride_; ++i)
+                    result[i] ^= src[i];
+            }
+        }
+        return result;
+    }
+
+    // M4RM: rows of rhs are taken 8 at a time, all 256 of their XOR combinations are tabulated,
+    // then every lhs row picks its combination with a single byte lookup
+    gf2_matrix operator*(const gf2_matrix& rhs) const {
+        if (cols_ != rhs.rows_)
+            throw std::invalid_argument("Dimension mismatch for matrix product");
+
+        constexpr size_t k = 8;
+        const size_t out_stride = rhs.stride_;
+        gf2_matrix result(rows_, rhs.cols_);
+        std::vector<std::uint64_t> table((size_t(1) << k) * out_stride);
+
+        for (size_t block = 0; block < rhs.rows_; block += k) {
+            const size_t kb = std::min(k, rhs.rows_ - block);
+            const size_t entries = size_t(1) << kb;
+
+            // table[i] = XOR of rhs rows (block + j) for every bit j set in i
+            for (size_t i = 1; i < entries; ++i) {
+                const auto* prev = &table[(i & (i - 1)) * out_stride];
+                const auto* src = rhs.row(block + std::countr_zero(i));
+                auto* dst = &table[i * out_stride];
+                for (size_t w = 0; w < out_stride; ++w)
+                    dst[w] = prev[w] ^ src[w];
+            }
+
+            // k divides 64, so a block never straddles a word boundary
+            const size_t word = block / 64;
+            const size_t shift = block % 64;
+            const std::uint64_t mask = entries - 1;
+            for (size_t r = 0; r < rows_; ++r) {
+                const auto idx = (row(r)[word] >> shift) & mask;
+                if (!idx)
+                    continue;
+
+                const auto* src = &table[idx * out_stride];
+                auto* dst = result.row(r);
+                for (size_t w = 0; w < out_stride; ++w)
+                    dst[w] ^= src[w];
+            }
+        }
+
+        return result;
+    }
+
+    gf2_matrix& operator*=(const gf2_matrix& rhs) {
+        *this = *this * rhs;
+        return *this;
+    }
+
+    // transposition is done in 64 x 64 bit blocks
+    gf2_matrix transpose() const {
+        gf2_matrix result(cols_, rows_);
+        std::uint64_t block[64];
+
+        for (size_t rb = 0; rb < rows_; rb += 64) {
+            const size_t nr = std::min<size_t>(64, rows_ - rb);
+            for (size_t cw = 0; cw < stride_; ++cw) {
+                for (size_t i = 0; i < 64; ++i)
+                    block[i] = i < nr ? row(rb + i)[cw] : 0;
+
+                transpose64(block);
+
+                const size_t nc = std::min<size_t>(64, cols_ - cw * 64);
+                for (size_t i = 0; i < nc; ++i)
+                    result.row(cw * 64 + i)[rb / 64] = block[i];
+            }
+        }
+
+        return result;
+    }
+
+    // in-place Gauss-Jordan elimination to the reduced row echelon form, returns the rank
+    size_t row_reduce() {
+        size_t rank = 0;
+        for (size_t c = 0; c < cols_ && rank < rows_; ++c) {
+            const size_t word = c / 64;
+            const std::uint64_t mask = std::uint64_t(1) << (c % 64);
+
+            size_t pivot = rank;
+            while (pivot < rows_ && !(row(pivot)[word] & mask))
+                ++pivot;
+
+            if (pivot == rows_)
+                continue;
+
+            if (pivot != rank)
+                std::swap_ranges(row(pivot), row(pivot) + stride_, row(rank));
+
+            // everything to the left of the pivot column is already zero in both rows
+            const auto* src = row(rank);
+            for (size_t r = 0; r < rows_; ++r) {
+                if (r == rank || !(row(r)[word] & mask))
+                    continue;
+
+                auto* dst = row(r);
+                for (size_t w = word; w < stride_; ++w)
+                    dst[w] ^= src[w];
+            }
+            ++rank;
+        }
+        return rank;
+    }
+
+    size_t rank() const {
+        gf2_matrix tmp = *this;
+        return tmp.row_reduce();
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const gf2_matrix& m) {
+        for (size_t r = 0; r < m.rows_; ++r) {
+            os << "[";
+            for (size_t c = 0; c < m.cols_; ++c) {
+                if (c > 0)
+                    os << ", ";
+
+                os << m(r, c);
+            }
+            os << "]\n";
+        }
+        return os;
+    }
+
+private:
+    template <typename T, typename A>
+    static size_t matrix_rows(const mdarray<T, A>& m) {
+        const auto& dims = m.dimensions();
+        if (dims.size() > 2)
+            throw std::invalid_argument("GF(2) matrix requires a 1D or 2D mdarray");
+
+        return dims.size() == 1 ? 1 : dims[0];
+    }
+
+    template <typename T, typename A>
+    static size_t matrix_cols(const mdarray<T, A>& m) {
+        return m.dimensions().back();
+    }
+
+    void check_index(size_t r, size_t c) const {
+        if (r >= rows_ || c >= cols_)
+            throw std::invalid_argument("Index out of bounds");
+    }
+
+    std::uint64_t tail_mask() const {
+        return packed_tail_mask(cols_);
+    }
+
+    // bit j of a[i] <-> bit i of a[j], recursive block swap from Hacker's Delight
+    static void transpose64(std::uint64_t a[64]) {
+        std::uint64_t m = 0x00000000FFFFFFFFull;
+        for (size_t j = 32; j != 0; j >>= 1, m ^= (m << j)) {
+            for (size_t k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+                const std::uint64_t t = ((a[k] >> j) ^ a[k | j]) & m;
+                a[k] ^= t << j;
+                a[k | j] ^= t;
+            }
+        }
+    }
+};
+
+} // namespace eccpp
+
+#endif // ECCPP_GF2_MATRIX_H
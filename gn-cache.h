@@ -0,0 +1,183 @@
+// process-wide cache of generator matrices keyed by n. Building a big G_n takes seconds and
+// gigabytes, so encoders for the same n created in different tasks/threads share a single
+// immutable copy instead:
+//   auto g = eccpp::gn_cached(n);        // std::shared_ptr<const mdarray<int>>
+// The first caller for a given n builds the matrix, concurrent callers for the same n wait for it,
+// callers for other n aren't blocked. With a memory limit set, least recently used matrices are
+// dropped from the cache once the total goes over it; handles already given out stay valid.
+
+#ifndef ECCPP_GN_CACHE_H
+#define ECCPP_GN_CACHE_H
+
+#include <memory>
+#include <mutex>
+#include <future>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+#include <chrono>
+
+#include "gn.h"
+
+namespace eccpp {
+
+namespace detail {
+
+template <typename T, typename A>
+size_t memory_footprint(const mdarray<T, A>& m) {
+    return m.size() * sizeof(T);
+}
+
+inline size_t memory_footprint(const gf2_matrix& m) {
+    return m.rows() * m.words_per_row() * sizeof(std::uint64_t);
+}
+
+template <typename T, sparse_layout L>
+size_t memory_footprint(const sparse_matrix<T, L>& m) {
+    const size_t major = L == sparse_layout::row_major ? m.rows() : m.cols();
+    return (major + 1) * sizeof(size_t) + m.nonzeros() * (sizeof(typename sparse_matrix<T, L>::index_type) + sizeof(T));
+}
+
+} // namespace detail
+
+template <typename Matrix>
+class generator_cache {
+public:
+    using handle = std::shared_ptr<const Matrix>;
+
+    explicit generator_cache(std::function<Matrix(size_t)> build): build_(std::move(build)) {}
+
+    generator_cache(const generator_cache&) = delete;
+    generator_cache& operator=(const generator_cache&) = delete;
+
+    handle get(size_t n) {
+        std::unique_lock lock(mutex_);
+        auto it = entries_.find(n);
+        if (it != entries_.end()) {
+            it->second.last_use = ++tick_;
+            auto result = it->second.value;
+            lock.unlock();
+            return result.get();    // waits if another thread is still building it
+        }
+
+        std::promise<handle> promise;
+        entries_.emplace(n, entry{promise.get_future().share(), 0, ++tick_});
+        lock.unlock();
+
+        // the entry isn't ready until the promise is fulfilled, so clear() and evict() leave it alone
+        // till then. Fulfilling it under the lock, together with the bookkeeping, means the entry
+        // for n is still this one
+        handle result;
+        try {
+            result = std::make_shared<const Matrix>(build_(n));
+        }
+        catch (...) {
+            // waiting callers get the exception, later ones try again
+            lock.lock();
+            promise.set_exception(std::current_exception());
+            entries_.erase(n);
+            throw;
+        }
+
+        const size_t bytes = detail::memory_footprint(*result);
+        lock.lock();
+        promise.set_value(result);
+        entries_.at(n).bytes = bytes;
+        total_bytes_ += bytes;
+        evict();
+        return result;
+    }
+
+    // 0 - no limit. Applies to the matrices held by the cache, not the handles held by callers
+    void set_memory_limit(size_t bytes) {
+        std::lock_guard lock(mutex_);
+        limit_ = bytes;
+        evict();
+    }
+
+    size_t memory_limit() const {
+        std::lock_guard lock(mutex_);
+        return limit_;
+    }
+
+    size_t memory_usage() const {
+        std::lock_guard lock(mutex_);
+        return total_bytes_;
+    }
+
+    bool contains(size_t n) const {
+        std::lock_guard lock(mutex_);
+        return entries_.count(n) != 0;
+    }
+
+    // drops every finished matrix, ones still being built stay
+    void clear() {
+        std::lock_guard lock(mutex_);
+        for (auto it = entries_.begin(); it != entries_.end(); ) {
+            if (is_ready(it->second)) {
+                total_bytes_ -= it->second.bytes;
+                it = entries_.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+
+private:
+    struct entry {
+        std::shared_future<handle> value;
+        size_t bytes;           // 0 until built
+        std::uint64_t last_use;
+    };
+
+    static bool is_ready(const entry& e) {
+        return e.value.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    // least recently used finished entries go first, the cache is tiny so a linear scan is fine
+    void evict() {
+        while (limit_ && total_bytes_ > limit_) {
+            auto victim = entries_.end();
+            for (auto it = entries_.begin(); it != entries_.end(); ++it)
+                if (it->second.bytes && is_ready(it->second) && (victim == entries_.end() || it->second.last_use < victim->second.last_use))
+                    victim = it;
+
+            if (victim == entries_.end())
+                break;
+
+            total_bytes_ -= victim->second.bytes;
+            entries_.erase(victim);
+        }
+    }
+
+    const std::function<Matrix(size_t)> build_;
+    mutable std::mutex mutex_;
+    std::unordered_map<size_t, entry> entries_;
+    std::uint64_t tick_ = 0;
+    size_t total_bytes_ = 0;
+    size_t limit_ = 0;
+};
+
+// the process-wide caches for the different G_n representations
+inline generator_cache<mdarray<int>>& gn_cache() {
+    static generator_cache<mdarray<int>> cache([](size_t n) { return gn(n); });
+    return cache;
+}
+
+inline generator_cache<gf2_matrix>& gn_gf2_cache() {
+    static generator_cache<gf2_matrix> cache([](size_t n) { return gn_gf2(n); });
+    return cache;
+}
+
+inline generator_cache<csc_matrix<int>>& gn_csc_cache() {
+    static generator_cache<csc_matrix<int>> cache([](size_t n) { return gn_csc(n); });
+    return cache;
+}
+
+inline std::shared_ptr<const mdarray<int>> gn_cached(size_t n) { return gn_cache().get(n); }
+inline std::shared_ptr<const gf2_matrix> gn_gf2_cached(size_t n) { return gn_gf2_cache().get(n); }
+inline std::shared_ptr<const csc_matrix<int>> gn_csc_cached(size_t n) { return gn_csc_cache().get(n); }
+
+} // namespace eccpp
+
+#endif // ECCPP_GN_CACHE_H
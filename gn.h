@@ -5,12 +5,18 @@
 #define ECCPP_GN_H
 
 #include <vector>
+#include <algorithm>
+#include <bit>
+#include <cstdint>
 
 #include "kron.h"
+#include "sparse.h"
 
 namespace eccpp {
 
-static mdarray<int> gn(size_t n) {
+// row blocks of the result go to separate threads under a parallel policy
+template <execution_policy P>
+mdarray<int> gn(P policy, size_t n) {
     if (!n || (n & (n - 1)) != 0)
         throw std::invalid_argument("n must be a power of 2");
 
@@ -26,11 +32,164 @@ static mdarray<int> gn(size_t n) {
     g2({1, 0}) = 1;
     g2({1, 1}) = 1;
 
-    auto gn = g2;
-    while ((n >>= 1) > 1)
-        gn = kron(gn, g2);
+    // all log2(n) factors in a single pass, no intermediate products
+    return kron_view<int>::power(g2, size_t(std::countr_zero(n))).to_mdarray(policy);
+}
+
+inline mdarray<int> gn(size_t n) {
+    return gn(execution::seq, n);
+}
+
+//
+// G_n without the n x n storage: G_n[r][c] is 1 iff c's bits are a subset of r's bits, i.e.
+// (r & c) == c, so any entry, row or column can be computed on demand. Handy for large n,
+// where gn() would need n^2 ints (4 GiB at n = 32768) plus all the intermediate Kronecker products.
+//
+class gn_view {
+public:
+    gn_view(size_t n): n_(n) {
+        if (!n || (n & (n - 1)) != 0)
+            throw std::invalid_argument("n must be a power of 2");
+    }
+
+    size_t size() const { return n_; }
+
+    int operator()(size_t r, size_t c) const {
+        return (r & c) == c;
+    }
+
+    int at(size_t r, size_t c) const {
+        if (r >= n_ || c >= n_)
+            throw std::invalid_argument("Index out of bounds");
+
+        return (*this)(r, c);
+    }
+
+    // number of 1s in row r, which is 2^popcount(r)
+    size_t row_weight(size_t r) const {
+        return size_t(1) << std::popcount(r);
+    }
+
+    // number of 1s in column c, which is 2^(log2(n) - popcount(c))
+    size_t column_weight(size_t c) const {
+        return n_ >> std::popcount(c);
+    }
+
+    std::vector<int> row(size_t r) const {
+        check_index(r);
+
+        std::vector<int> result(n_);
+        for_each_in_row(r, [&](size_t c) { result[c] = 1; });
+        return result;
+    }
+
+    std::vector<int> column(size_t c) const {
+        check_index(c);
+
+        std::vector<int> result(n_);
+        for_each_in_column(c, [&](size_t r) { result[r] = 1; });
+        return result;
+    }
+
+    // row r packed into 64-bit words, column c is bit (c % 64) of word c / 64
+    std::vector<std::uint64_t> packed_row(size_t r) const {
+        check_index(r);
+
+        std::vector<std::uint64_t> result((n_ + 63) / 64);
+        for_each_in_row(r, [&](size_t c) { result[c / 64] |= std::uint64_t(1) << (c % 64); });
+        return result;
+    }
+
+    // calls fn(c) for every column c with a 1 in row r, in descending order. Costs O(row weight)
+    // rather than O(n): these are exactly the submasks of r
+    template<typename Fn>
+    void for_each_in_row(size_t r, Fn&& fn) const {
+        for (size_t c = r; ; c = (c - 1) & r) {
+            fn(c);
+            if (!c)
+                break;
+        }
+    }
+
+    // calls fn(r) for every row r with a 1 in column c, in ascending order (supersets of c)
+    template<typename Fn>
+    void for_each_in_column(size_t c, Fn&& fn) const {
+        for (size_t r = c; r < n_; r = (r + 1) | c)
+            fn(r);
+    }
+
+    mdarray<int> to_mdarray() const {
+        return gn(n_);
+    }
+
+private:
+    void check_index(size_t i) const {
+        if (i >= n_)
+            throw std::invalid_argument("Index out of bounds");
+    }
+
+    size_t n_;
+};
+
+// G_n as a lazy chain of log2(n) g2 factors, products with it cost O(n log n) (see kron_view)
+inline kron_view<int> gn_kron_view(size_t n) {
+    if (!n || (n & (n - 1)) != 0)
+        throw std::invalid_argument("n must be a power of 2");
+
+    mdarray<int> g2({2, 2});
+    g2({0, 0}) = 1;
+    g2({1, 0}) = 1;
+    g2({1, 1}) = 1;
+
+    if (n == 1)
+        return kron_view<int>({mdarray<int>({1, 1}, std::vector<int>{1})});
+
+    return kron_view<int>::power(g2, size_t(std::countr_zero(n)));
+}
+
+// packed GF(2) G_n, n^2 / 8 bytes instead of n^2 ints
+inline gf2_matrix gn_gf2(size_t n) {
+    const gn_view view(n);
+
+    gf2_matrix result(n, n);
+    for (size_t r = 0; r < n; ++r) {
+        auto* dst = result.row(r);
+        view.for_each_in_row(r, [&](size_t c) { dst[c / 64] |= std::uint64_t(1) << (c % 64); });
+    }
+    return result;
+}
+
+// sparse G_n, 3^log2(n) nonzeros instead of n^2 elements (14.3M vs 1G at n = 32768)
+inline csr_matrix<int> gn_csr(size_t n) {
+    const gn_view view(n);
+
+    std::vector<size_t> offsets(1, 0);
+    std::vector<std::uint32_t> indices;
+    offsets.reserve(n + 1);
+    for (size_t r = 0; r < n; ++r) {
+        const size_t begin = indices.size();
+        view.for_each_in_row(r, [&](size_t c) { indices.push_back(std::uint32_t(c)); });
+        std::reverse(indices.begin() + begin, indices.end());
+        offsets.push_back(indices.size());
+    }
+
+    std::vector<int> values(indices.size(), 1);
+    return csr_matrix<int>(n, n, std::move(offsets), std::move(indices), std::move(values));
+}
+
+inline csc_matrix<int> gn_csc(size_t n) {
+    const gn_view view(n);
+
+    std::vector<size_t> offsets(1, 0);
+    std::vector<std::uint32_t> indices;
+    offsets.reserve(n + 1);
+    for (size_t c = 0; c < n; ++c) {
+        view.for_each_in_column(c, [&](size_t r) { indices.push_back(std::uint32_t(r)); });
+        offsets.push_back(indices.size());
+    }
 
-    return gn;
+    std::vector<int> values(indices.size(), 1);
+    return csc_matrix<int>(n, n, std::move(offsets), std::move(indices), std::move(values));
 }
 
 } // namespace eccpp
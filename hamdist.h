@@ -2,8 +2,11 @@
 #define ECCPP_HAMDIST_H
 
 #include <vector>
+#include <span>
+#include <cstdint>
 #include <cassert>
 
+#include "bitpack.h"
 #include "mdarray.h"
 
 namespace eccpp {
@@ -26,12 +29,29 @@ size_t hamdist(const std::vector<T>& a, const std::vector<T>& b) {
     return distance;
 }
 
-template <typename T>
-size_t hamdist(const mdarray<T>& a, const mdarray<T>& b) {
+// works for any mix of mdarrays and views
+template <typename A, typename B> requires mdarray_like<A> && mdarray_like<B>
+size_t hamdist(const A& a, const B& b) {
+    using T = typename A::value_type;
     if (a.dimensions() != b.dimensions())
         throw std::invalid_argument("Hamming distance: dimensions must match");
 
     size_t distance = 0;
+
+    // contiguous data: a single flat loop, which the compiler vectorises
+    const auto* a_data = detail::contiguous_data(a);
+    const auto* b_data = detail::contiguous_data(b);
+    if (a_data && b_data) {
+        const size_t n = a.size();
+        for (size_t i = 0; i < n; ++i) {
+            assert(a_data[i] == 0 || a_data[i] == 1);
+            assert(b_data[i] == 0 || b_data[i] == 1);
+
+            distance += (a_data[i] != b_data[i]);
+        }
+        return distance;
+    }
+
     const auto& dims = a.dimensions();
     std::vector<size_t> indices(dims.size(), 0);
 
@@ -63,6 +83,25 @@ size_t hamdist(const mdarray<T>& a, const mdarray<T>& b) {
     return distance;
 }
 
+// bits packed 64 per word (bitpack.h): popcount of a ^ b, see detail::popcount_words()
+inline size_t hamdist_packed(std::span<const std::uint64_t> a, std::span<const std::uint64_t> b) {
+    if (a.size() != b.size())
+        throw std::invalid_argument("Hamming distance: dimensions must match");
+
+    return detail::popcount_words<true>(a.data(), b.data(), a.size());
+}
+
+// one vector against many: many holds out.size() vectors of a.size() words back to back, out[i]
+// gets the distance to the i-th one
+inline void hamdist_packed(std::span<const std::uint64_t> a, std::span<const std::uint64_t> many, std::span<size_t> out) {
+    const size_t words = a.size();
+    if (many.size() != words * out.size())
+        throw std::invalid_argument("Hamming distance: dimensions must match");
+
+    for (size_t i = 0; i < out.size(); ++i)
+        out[i] = detail::popcount_words<true>(a.data(), many.data() + i * words, words);
+}
+
 } // namespace eccpp
 
 #endif // ECCPP_HAMDIST_H
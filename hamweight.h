@@ -2,8 +2,11 @@
 #define ECCPP_HAMWEIGHT_H
 
 #include <vector>
+#include <span>
+#include <cstdint>
 #include <cassert>
 
+#include "bitpack.h"
 #include "mdarray.h"
 
 namespace eccpp {
@@ -20,9 +23,23 @@ size_t hamweight(const std::vector<T>& a) {
     return weight;
 }
 
-template <typename T>
-size_t hamweight(const mdarray<T>& a) {
+// works for mdarrays and views
+template <typename A> requires mdarray_like<A>
+size_t hamweight(const A& a) {
+    using T = typename A::value_type;
     size_t weight = 0;
+
+    // contiguous data: a single flat loop, which the compiler vectorises
+    if (const auto* data = detail::contiguous_data(a)) {
+        const size_t n = a.size();
+        for (size_t i = 0; i < n; ++i) {
+            assert(data[i] == 0 || data[i] == 1);
+
+            weight += (data[i] != 0);
+        }
+        return weight;
+    }
+
     const auto& dims = a.dimensions();
     std::vector<size_t> indices(dims.size(), 0);
 
@@ -52,6 +69,11 @@ size_t hamweight(const mdarray<T>& a) {
     return weight;
 }
 
+// bits packed 64 per word (bitpack.h), counted a word at a time or better, see detail::popcount_words()
+inline size_t hamweight_packed(std::span<const std::uint64_t> a) {
+    return detail::popcount_words<false>(a.data(), a.data(), a.size());
+}
+
 } // namespace eccpp
 
 #endif // ECCPP_HAMWEIGHT_H
@@ -3,29 +3,275 @@
 #ifndef ECCPP_KRON_H
 #define ECCPP_KRON_H
 
+#include <vector>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+
+#include "execution.h"
 #include "mdarray.h"
+#include "gf2-matrix.h"
 
 namespace eccpp {
 
+namespace detail {
+
+inline size_t kron_checked_product(size_t a, size_t b) {
+    if (b && a > std::numeric_limits<size_t>::max() / b)
+        throw std::invalid_argument("Dimensions too large");
+
+    return a * b;
+}
+
+// A_1 (x) ... (x) A_m in a single pass. Row r of the result is the Kronecker product of one row
+// of every factor, so it's built right to left inside the output row: the last factor's row is
+// copied in, then every further factor turns the L elements built so far into c_k blocks of L,
+// each a scaled copy of the first one. That's under 2 writes per element, all contiguous.
+// Row blocks go to separate threads under a parallel policy
+template <execution_policy P, typename T, typename A>
+mdarray<T, A> kron_factors(P policy, const std::vector<const mdarray<T, A>*>& factors) {
+    if (factors.empty())
+        throw std::invalid_argument("Kronecker product requires at least one factor");
+
+    size_t rows = 1;
+    size_t cols = 1;
+    for (const auto* f: factors) {
+        if (f->dimensions().size() != 2)
+            throw std::invalid_argument("Kronecker product requires 2D matrices");
+
+        rows = kron_checked_product(rows, f->dimensions()[0]);
+        cols = kron_checked_product(cols, f->dimensions()[1]);
+    }
+
+    mdarray<T, A> result({rows, cols}, factors.front()->get_allocator());
+    T* out = result.data();
+    const size_t m = factors.size();
+
+    // the threshold is in elements, a row is cols of them
+    const size_t min_rows = std::max<size_t>(1, min_parallel_elements / cols);
+    detail::for_each_range(policy, rows, 1, min_rows, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            T* row = out + r * cols;
+
+            // row index digits, the last factor is the least significant one
+            size_t rem = r;
+            size_t len = 0;
+            for (size_t k = m; k-- > 0; ) {
+                const auto& dims = factors[k]->dimensions();
+                const T* src = factors[k]->data() + (rem % dims[0]) * dims[1];
+                rem /= dims[0];
+
+                if (!len) {
+                    std::copy(src, src + dims[1], row);
+                    len = dims[1];
+                    continue;
+                }
+
+                // block 0 is the source of every other block, so it's scaled last
+                for (size_t j = dims[1]; j-- > 1; ) {
+                    const T a = src[j];
+                    T* dst = row + j * len;
+                    for (size_t i = 0; i < len; ++i)
+                        dst[i] = a * row[i];
+                }
+
+                const T a0 = src[0];
+                for (size_t i = 0; i < len; ++i)
+                    row[i] *= a0;
+
+                len *= dims[1];
+            }
+        }
+    });
+
+    return result;
+}
+
+} // namespace detail
+
+// kron(A, B, C, ...) = A (x) B (x) C (x) ..., built in one pass without intermediate products
+template <typename T, typename A, typename... Rest> requires (std::is_same_v<Rest, mdarray<T, A>> && ...)
+mdarray<T, A> kron(const mdarray<T, A>& first, const Rest&... rest) {
+    return detail::kron_factors(execution::seq, std::vector<const mdarray<T, A>*>{&first, &rest...});
+}
+
+template <execution_policy P, typename T, typename A, typename... Rest> requires (std::is_same_v<Rest, mdarray<T, A>> && ...)
+mdarray<T, A> kron(P policy, const mdarray<T, A>& first, const Rest&... rest) {
+    return detail::kron_factors(policy, std::vector<const mdarray<T, A>*>{&first, &rest...});
+}
+
+//
+// lazy Kronecker product A_1 (x) A_2 (x) ... (x) A_m of 2D factors, only the factors are stored.
+// Row r of the product is made of the mixed-radix digits (r_1, ..., r_m) of r, with r_m the least
+// significant one, and the element is A_1(r_1, c_1) * ... * A_m(r_m, c_m).
+// Matrix-vector products use the shuffle algorithm: x is viewed as a c_1 x ... x c_m tensor and
+// every factor is applied along its own axis, O(N * sum of factor sizes) instead of O(N^2) for
+// N x N, e.g. 2N log2(N) multiply-adds for G_N = kron of log2(N) 2x2 factors.
+//
 template <typename T>
-mdarray<T> kron(const mdarray<T>& m1, const mdarray<T>& m2) {
-    if (m1.dimensions().size() != 2 || m2.dimensions().size() != 2)
-        throw std::invalid_argument("Kronecker product requires 2D matrices");
+class kron_view {
+public:
+    using value_type = T;
+
+    explicit kron_view(std::vector<mdarray<T>> factors): factors_(std::move(factors)) {
+        if (factors_.empty())
+            throw std::invalid_argument("Kronecker product requires at least one factor");
+
+        rows_ = cols_ = 1;
+        for (const auto& f: factors_) {
+            if (f.dimensions().size() != 2)
+                throw std::invalid_argument("Kronecker product requires 2D matrices");
+
+            rows_ = detail::kron_checked_product(rows_, f.dimensions()[0]);
+            cols_ = detail::kron_checked_product(cols_, f.dimensions()[1]);
+        }
+    }
+
+    // factor (x) factor (x) ... (x) factor, count times
+    static kron_view power(const mdarray<T>& factor, size_t count) {
+        return kron_view(std::vector<mdarray<T>>(count, factor));
+    }
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    std::vector<size_t> dimensions() const { return {rows_, cols_}; }
+    const std::vector<mdarray<T>>& factors() const { return factors_; }
+
+    T operator()(size_t r, size_t c) const {
+        if (r >= rows_ || c >= cols_)
+            throw std::invalid_argument("Index out of bounds");
+
+        T result = T(1);
+        for (size_t k = factors_.size(); k-- > 0; ) {
+            const auto& dims = factors_[k].dimensions();
+            result *= factors_[k].data()[(r % dims[0]) * dims[1] + c % dims[1]];
+            r /= dims[0];
+            c /= dims[1];
+        }
+        return result;
+    }
+
+    // K * x
+    std::vector<T> multiply(const std::vector<T>& x) const {
+        if (x.size() != cols_)
+            throw std::invalid_argument("Dimension mismatch for matrix-vector product");
+
+        return apply(x, false, [](T a, T b) { return a * b; }, [](T a, T b) { return a + b; });
+    }
+
+    std::vector<T> operator*(const std::vector<T>& x) const { return multiply(x); }
+
+    // K^T * x, i.e. x as a row vector times K
+    std::vector<T> transpose_multiply(const std::vector<T>& x) const {
+        if (x.size() != rows_)
+            throw std::invalid_argument("Dimension mismatch for vector-matrix product");
+
+        return apply(x, true, [](T a, T b) { return a * b; }, [](T a, T b) { return a + b; });
+    }
+
+    // the same products over GF(2): non-zero factor elements and odd vector elements count as 1
+    std::vector<T> gf2_multiply(const std::vector<T>& x) const {
+        if (x.size() != cols_)
+            throw std::invalid_argument("Dimension mismatch for matrix-vector product");
+
+        return apply(x, false, [](T a, T b) { return T(a != T() && (b & 1)); }, [](T a, T b) { return T(a ^ b); });
+    }
+
+    std::vector<T> gf2_transpose_multiply(const std::vector<T>& x) const {
+        if (x.size() != rows_)
+            throw std::invalid_argument("Dimension mismatch for vector-matrix product");
+
+        return apply(x, true, [](T a, T b) { return T(a != T() && (b & 1)); }, [](T a, T b) { return T(a ^ b); });
+    }
+
+    // dense copy, rows() x cols()
+    mdarray<T> to_mdarray() const {
+        return to_mdarray(execution::seq);
+    }
+
+    template <execution_policy P>
+    mdarray<T> to_mdarray(P policy) const {
+        std::vector<const mdarray<T>*> factors;
+        for (const auto& f: factors_)
+            factors.push_back(&f);
+
+        return detail::kron_factors(policy, factors);
+    }
+
+private:
+    // applies factor k along axis k: the current tensor is [left][in_k][right] with the axes
+    // before k already transformed, the result is [left][out_k][right]. The innermost loop runs
+    // over the contiguous right part
+    template <typename Mul, typename Add>
+    std::vector<T> apply(const std::vector<T>& x, bool transposed, Mul mul, Add add) const {
+        std::vector<T> cur = x;
+        std::vector<T> next;
+
+        size_t left = 1;
+        size_t right = transposed ? rows_ : cols_;
+        for (const auto& f: factors_) {
+            const auto& dims = f.dimensions();
+            const size_t in = transposed ? dims[0] : dims[1];
+            const size_t out = transposed ? dims[1] : dims[0];
+            right /= in;
+
+            next.assign(left * out * right, T());
+            for (size_t l = 0; l < left; ++l) {
+                const T* src = cur.data() + l * in * right;
+                T* dst = next.data() + l * out * right;
+
+                for (size_t i = 0; i < out; ++i) {
+                    T* d = dst + i * right;
+                    for (size_t j = 0; j < in; ++j) {
+                        const T a = transposed ? f.data()[j * dims[1] + i] : f.data()[i * dims[1] + j];
+                        if (a == T())
+                            continue;
+
+                        const T* s = src + j * right;
+                        for (size_t k = 0; k < right; ++k)
+                            d[k] = add(d[k], mul(a, s[k]));
+                    }
+                }
+            }
+
+            cur.swap(next);
+            left *= out;
+        }
+        return cur;
+    }
+
+    std::vector<mdarray<T>> factors_;
+    size_t rows_;
+    size_t cols_;
+};
+
+// GF(2) version: every output row is m2's row placed at each column block selected by m1's row
+inline gf2_matrix kron(const gf2_matrix& m1, const gf2_matrix& m2) {
+    const size_t rows2 = m2.rows();
+    const size_t cols2 = m2.cols();
+    const size_t src_words = m2.words_per_row();
 
-    const size_t rows1 = m1.dimensions()[0];
-    const size_t cols1 = m1.dimensions()[1];
-    const size_t rows2 = m2.dimensions()[0];
-    const size_t cols2 = m2.dimensions()[1];
+    gf2_matrix result(m1.rows() * rows2, m1.cols() * cols2);
+    const size_t dst_words = result.words_per_row();
 
-    mdarray<T> result({rows1 * rows2, cols1 * cols2});
+    for (size_t r1 = 0; r1 < m1.rows(); ++r1) {
+        for (size_t r2 = 0; r2 < rows2; ++r2) {
+            auto* dst = result.row(r1 * rows2 + r2);
+            const auto* src = m2.row(r2);
 
-    for (size_t r1 = 0; r1 < rows1; ++r1) {
-        for (size_t c1 = 0; c1 < cols1; ++c1) {
-            const T val = m1({r1, c1});
+            for (size_t c1 = 0; c1 < m1.cols(); ++c1) {
+                if (!m1(r1, c1))
+                    continue;
 
-            for (size_t r2 = 0; r2 < rows2; ++r2) {
-                for (size_t c2 = 0; c2 < cols2; ++c2) {
-                    result({r1 * rows2 + r2, c1 * cols2 + c2}) = val * m2({r2, c2});
+                // OR src into dst starting at bit c1 * cols2
+                const size_t bit_off = c1 * cols2;
+                const size_t shift = bit_off % 64;
+                for (size_t w = 0; w < src_words; ++w) {
+                    const size_t dw = bit_off / 64 + w;
+                    dst[dw] |= src[w] << shift;
+                    if (shift && dw + 1 < dst_words)
+                        dst[dw + 1] |= src[w] >> (64 - shift);
                 }
             }
         }
@@ -0,0 +1,174 @@
+// quasi-cyclic (QC) LDPC codes. The parity-check matrix H is an mb x nb grid of z x z blocks
+// given by a base matrix: -1 is an all-zero block, s >= 0 is the identity cyclically shifted by s,
+// i.e. row i of the block has its 1 in column (i + s) % z. That's the form 802.11n/ac, 802.16e and
+// 5G NR use. A codeword c of length n = nb * z is any c with H * c^T = 0 over GF(2).
+
+#ifndef ECCPP_LDPC_CODE_H
+#define ECCPP_LDPC_CODE_H
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <bit>
+#include <limits>
+
+#include "bitpack.h"
+#include "gf2-matrix.h"
+#include "sparse.h"
+#include "mdarray.h"
+
+namespace eccpp {
+
+class qc_ldpc_code {
+public:
+    // one nonzero block of the base matrix
+    struct block {
+        size_t col;
+        size_t shift;
+    };
+
+    qc_ldpc_code(mdarray<int> base, size_t z): base_(std::move(base)), z_(z), layers_(make_layers(base_, z)),
+        h_(make_parity_check(layers_, z, base_.dimensions()[1])), equations_(systematic_form()) {}
+
+    size_t z() const { return z_; }
+    size_t n() const { return base_.dimensions()[1] * z_; }
+    size_t checks() const { return base_.dimensions()[0] * z_; }
+
+    // number of message bits, n minus the rank of H (which can be less than checks())
+    size_t k() const { return info_bits_.size(); }
+
+    const mdarray<int>& base() const { return base_; }
+
+    // the nonzero blocks of every block row, in ascending column order. A block row touches every
+    // bit at most once, which is what lets a layered decoder process it as a whole
+    const std::vector<std::vector<block>>& layers() const { return layers_; }
+
+    const csr_matrix<int>& parity_check() const { return h_; }
+
+    // codeword positions of the message bits and of the parity bits, see parity_equations()
+    const std::vector<size_t>& info_bits() const { return info_bits_; }
+    const std::vector<size_t>& parity_bits() const { return parity_bits_; }
+
+    // H in reduced row echelon form, restricted to its rank: row r has a single 1 among the parity
+    // positions, at parity_bits()[r], so that parity bit is the XOR of the message bits set in
+    // the row. Parity positions are taken from the right as far as possible, so with the usual
+    // layouts (parity blocks last) the message comes first in the codeword
+    const gf2_matrix& parity_equations() const { return equations_; }
+
+    // H * c^T, one bit per check
+    std::vector<int> syndrome(const std::vector<int>& codeword) const {
+        if (codeword.size() != n())
+            throw std::invalid_argument("Codeword size must match code length");
+
+        return unpack_bits(h_.gf2_multiply(execution::seq, pack_bits(codeword)), checks());
+    }
+
+    bool is_codeword(const std::vector<int>& codeword) const {
+        if (codeword.size() != n())
+            throw std::invalid_argument("Codeword size must match code length");
+
+        for (auto w: h_.gf2_multiply(execution::seq, pack_bits(codeword)))
+            if (w)
+                return false;
+
+        return true;
+    }
+
+private:
+    static std::vector<std::vector<block>> make_layers(const mdarray<int>& base, size_t z) {
+        const auto& dims = base.dimensions();
+        if (dims.size() != 2 || !dims[0] || !dims[1])
+            throw std::invalid_argument("Base matrix must be a non-empty 2D matrix");
+
+        if (!z)
+            throw std::invalid_argument("Lifting size must be positive");
+
+        if (dims[1] > std::numeric_limits<csr_matrix<int>::index_type>::max() / z)
+            throw std::invalid_argument("Code length too large");
+
+        std::vector<std::vector<block>> layers(dims[0]);
+        for (size_t r = 0; r < dims[0]; ++r) {
+            for (size_t c = 0; c < dims[1]; ++c) {
+                const int s = base({r, c});
+                if (s < -1 || (s >= 0 && size_t(s) >= z))
+                    throw std::invalid_argument("Base matrix entries must be -1 or shifts in [0, z)");
+
+                if (s >= 0)
+                    layers[r].push_back({c, size_t(s)});
+            }
+
+            // a single bit check just says the bit is 0, there is nothing to pass around
+            if (layers[r].size() < 2)
+                throw std::invalid_argument("Every base matrix row needs at least 2 non-negative entries");
+        }
+        return layers;
+    }
+
+    static csr_matrix<int> make_parity_check(const std::vector<std::vector<block>>& layers, size_t z, size_t nb) {
+        using index_type = csr_matrix<int>::index_type;
+
+        std::vector<size_t> offsets{0};
+        std::vector<index_type> indices;
+        for (const auto& layer: layers) {
+            for (size_t i = 0; i < z; ++i) {
+                // blocks are in column order, so are the columns within a row
+                for (const auto& b: layer)
+                    indices.push_back(index_type(b.col * z + (i + b.shift) % z));
+
+                offsets.push_back(indices.size());
+            }
+        }
+
+        const size_t nnz = indices.size();
+        return csr_matrix<int>(layers.size() * z, nb * z, std::move(offsets), std::move(indices), std::vector<int>(nnz, 1));
+    }
+
+    // Gauss-Jordan on H with the columns reversed, so the pivots (parity bits) prefer the last
+    // columns. Fills info_bits_ and parity_bits_
+    gf2_matrix systematic_form() {
+        const size_t N = n();
+        gf2_matrix reversed(checks(), N);
+        for (size_t r = 0; r < checks(); ++r)
+            for (auto c: h_.indices(r))
+                reversed.set(r, N - 1 - c, 1);
+
+        // every row has a nonzero, so the rank is at least 1
+        const size_t rank = reversed.row_reduce();
+
+        std::vector<char> is_parity(N, 0);
+        gf2_matrix result(rank, N);
+        for (size_t r = 0; r < rank; ++r) {
+            const auto* src = reversed.row(r);
+            for (size_t w = 0; w < reversed.words_per_row(); ++w) {
+                for (auto bits = src[w]; bits; bits &= bits - 1) {
+                    const size_t c = N - 1 - (w * 64 + std::countr_zero(bits));
+                    result.set(r, c, 1);
+
+                    // the lowest reversed column is the pivot
+                    if (parity_bits_.size() == r) {
+                        parity_bits_.push_back(c);
+                        is_parity[c] = 1;
+                    }
+                }
+            }
+        }
+
+        for (size_t c = 0; c < N; ++c)
+            if (!is_parity[c])
+                info_bits_.push_back(c);
+
+        return result;
+    }
+
+    mdarray<int> base_;
+    size_t z_;
+    std::vector<std::vector<block>> layers_;
+    csr_matrix<int> h_;
+    std::vector<size_t> info_bits_;     // filled by systematic_form(), so declared before equations_
+    std::vector<size_t> parity_bits_;
+    gf2_matrix equations_;
+};
+
+} // namespace eccpp
+
+#endif // ECCPP_LDPC_CODE_H
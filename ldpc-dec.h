@@ -0,0 +1,290 @@
+// layered belief propagation decoder for QC-LDPC codes (ldpc-code.h). Every block row of the base
+// matrix is a layer; a layer touches every bit at most once, so its checks are updated together
+// and the bit LLRs are refreshed right after, which converges about twice as fast as flooding.
+// The check node update is minstar_extrinsic() (minstar.h) with any minstar_mode: the min-sum ones
+// are the usual hardware choice, exact / jacobian_lut are the full sum-product algorithm. Groups of
+// frames run the same update lane by lane. Decoding stops as soon as the hard decisions satisfy
+// every check.
+
+#ifndef ECCPP_LDPC_DEC_H
+#define ECCPP_LDPC_DEC_H
+
+#include <vector>
+#include <array>
+#include <span>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#include "allocator.h"
+#include "execution.h"
+#include "ldpc-code.h"
+#include "minstar.h"
+
+namespace eccpp {
+
+template <typename T>
+class ldpc_dec {
+public:
+    // frames decoded side by side by decode(llrs), see below
+    static constexpr size_t max_lanes = 16;
+
+    ldpc_dec(qc_ldpc_code code, size_t max_iterations = 20,
+        minstar_config<T> config = {minstar_mode::normalized_min_sum, T(0.5), T(0.75)}) :
+        code_(std::move(code)), max_iterations_(max_iterations), config_(config) {
+        for (size_t r = 0; r < code_.checks(); ++r)
+            max_degree_ = std::max(max_degree_, code_.parity_check().indices(r).size());
+    }
+
+    struct result {
+        std::vector<int> msg;
+        std::vector<int> codeword;
+        size_t iterations = 0;      // 0 if the channel hard decisions were a codeword already
+        bool success = false;       // stopped on a codeword, which isn't necessarily the one sent
+    };
+
+    const qc_ldpc_code& code() const { return code_; }
+
+    // llr is log(p(0)/p(1)) per codeword bit, same as polar_dec: negative means 1 is more likely,
+    // zero is an erasure
+    result decode(const std::vector<T>& llr) const {
+        result dec_result;
+        const std::vector<T>* frames[] = {&llr};
+        decode_lanes<true>(frames, 1, &dec_result);
+        return dec_result;
+    }
+
+    // several frames at once, interleaved bit by bit in groups of max_lanes, so every update is a
+    // loop over the frames of a group that vectorises. A frame's result is taken as soon as it
+    // decodes, the group runs until all its frames are done or max_iterations is reached
+    std::vector<result> decode(const std::vector<std::vector<T>>& llrs) const {
+        std::vector<result> results(llrs.size());
+        std::vector<const std::vector<T>*> frames(llrs.size());
+        for (size_t i = 0; i < llrs.size(); ++i)
+            frames[i] = &llrs[i];
+
+        for (size_t begin = 0; begin < llrs.size(); begin += max_lanes)
+            decode_lanes<false>(frames.data() + begin, std::min(max_lanes, llrs.size() - begin), results.data() + begin);
+
+        return results;
+    }
+
+private:
+    using buffer = std::vector<T, aligned_allocator<T>>;
+
+    // a single frame gets its own instantiation with plain scalar loops, the lane loops would be
+    // all setup and no work there
+    template <bool Single>
+    void decode_lanes(const std::vector<T>* const* llrs, size_t frames, result* results) const {
+        const size_t n = code_.n();
+        for (size_t f = 0; f < frames; ++f)
+            if (llrs[f]->size() != n)
+                throw std::invalid_argument("LLR size must match code length");
+
+        switch (config_.mode) {
+        case minstar_mode::exact:
+            run<minstar_mode::exact, Single>(llrs, frames, results);
+            break;
+        case minstar_mode::jacobian_lut:
+            run<minstar_mode::jacobian_lut, Single>(llrs, frames, results);
+            break;
+        case minstar_mode::offset_min_sum:
+            run<minstar_mode::offset_min_sum, Single>(llrs, frames, results);
+            break;
+        case minstar_mode::normalized_min_sum:
+            run<minstar_mode::normalized_min_sum, Single>(llrs, frames, results);
+            break;
+        }
+    }
+
+    // L[bit * F + f] - posterior LLRs, R[edge * F + f] - check to bit messages, edges in the
+    // order of the parity check matrix nonzeros. F is frames rounded up to a multiple of 4, the
+    // spare lanes decode a copy of the first frame and are ignored. It's deliberately not a
+    // compile time constant for groups: GCC would fully unroll the lane loops and then fail to
+    // if-convert them
+    template <minstar_mode Mode, bool Single>
+    void run(const std::vector<T>* const* llrs, size_t frames, result* results) const {
+        const auto& h = code_.parity_check();
+        const size_t n = code_.n();
+        const size_t F = Single ? 1 : (frames + 3) / 4 * 4;
+
+        buffer L(n * F);
+        buffer R(h.nonzeros() * F, T(0));
+        buffer Q(max_degree_ * F);
+        buffer scratch(4 * F);
+        for (size_t i = 0; i < n; ++i)
+            for (size_t f = 0; f < F; ++f)
+                L[i * F + f] = (*llrs[f < frames ? f : 0])[i];
+
+        std::array<bool, max_lanes> done{};
+        size_t remaining = frames;
+        auto finish = [&](size_t iteration) {
+            const auto unsatisfied = find_unsatisfied(L.data(), F);
+            for (size_t f = 0; f < frames; ++f) {
+                if (done[f] || (unsatisfied[f] && iteration < max_iterations_))
+                    continue;
+
+                results[f] = make_result(L.data(), F, f, iteration, !unsatisfied[f]);
+                done[f] = true;
+                --remaining;
+            }
+        };
+
+        finish(0);
+        for (size_t iteration = 1; remaining && iteration <= max_iterations_; ++iteration) {
+            T* edge = R.data();
+            for (size_t r = 0; r < code_.checks(); ++r) {
+                const auto cols = h.indices(r);
+                const size_t d = cols.size();
+
+                // bit to check messages: the posterior without what this check said last time
+                for (size_t e = 0; e < d; ++e) {
+                    const T* l = L.data() + size_t(cols[e]) * F;
+                    const T* rr = edge + e * F;
+                    T* q = Q.data() + e * F;
+                    ECCPP_SIMD_LOOP
+                    for (size_t f = 0; f < F; ++f)
+                        q[f] = l[f] - rr[f];
+                }
+
+                check_update<Mode, Single>(Q.data(), edge, d, F, scratch.data());
+
+                for (size_t e = 0; e < d; ++e) {
+                    T* l = L.data() + size_t(cols[e]) * F;
+                    const T* rr = edge + e * F;
+                    const T* q = Q.data() + e * F;
+                    ECCPP_SIMD_LOOP
+                    for (size_t f = 0; f < F; ++f)
+                        l[f] = q[f] + rr[f];
+                }
+                edge += d * F;
+            }
+            finish(iteration);
+        }
+    }
+
+    // out[e] = the min-star of every q but q[e], for every lane
+    template <minstar_mode Mode, bool Single>
+    void check_update(const T* q, T* out, size_t d, size_t F, T* scratch) const {
+        if constexpr (Single)
+            minstar_extrinsic<T>(std::span<const T>(q, d), std::span<T>(out, d), config_);
+        else if constexpr (Mode == minstar_mode::offset_min_sum || Mode == minstar_mode::normalized_min_sum) {
+            // minstar_extrinsic's min1 / min2 reduction, lane by lane. The index of min1 is kept
+            // as T so the loops work on a single element type
+            T* min1 = scratch;
+            T* min2 = scratch + F;
+            T* min1_index = scratch + 2 * F;
+            T* sign = scratch + 3 * F;
+            std::fill(min1, min1 + 2 * F, std::numeric_limits<T>::infinity());
+            std::fill(min1_index, min1_index + F, T(0));
+            std::fill(sign, sign + F, T(1));
+
+            // everything goes through locals: GCC won't if-convert the selects if they load from
+            // the arrays themselves
+            for (size_t e = 0; e < d; ++e) {
+                const T* x = q + e * F;
+                const T index = T(e);
+                ECCPP_SIMD_LOOP
+                for (size_t f = 0; f < F; ++f) {
+                    const T v = x[f];
+                    const T av = std::abs(v);
+                    const T m1 = min1[f];
+                    const T m2 = min2[f];
+                    const T i = min1_index[f];
+                    const T s = sign[f];
+                    const T second = av < m2 ? av : m2;
+                    sign[f] = v < T(0) ? -s : s;
+                    min2[f] = av < m1 ? m1 : second;
+                    min1_index[f] = av < m1 ? index : i;
+                    min1[f] = av < m1 ? av : m1;
+                }
+            }
+
+            // magnitudes in place of the minimums
+            ECCPP_SIMD_LOOP
+            for (size_t f = 0; f < F; ++f) {
+                min1[f] = detail::minstar_magnitude<Mode>(min1[f], min1[f], config_.offset, config_.scale, static_cast<const T*>(nullptr));
+                min2[f] = detail::minstar_magnitude<Mode>(min2[f], min2[f], config_.offset, config_.scale, static_cast<const T*>(nullptr));
+            }
+
+            for (size_t e = 0; e < d; ++e) {
+                const T* x = q + e * F;
+                T* o = out + e * F;
+                const T index = T(e);
+                ECCPP_SIMD_LOOP
+                for (size_t f = 0; f < F; ++f) {
+                    const T v = x[f];
+                    const T m1 = min1[f];
+                    const T m2 = min2[f];
+                    const T i = min1_index[f];
+                    const T s = sign[f];
+                    const T m = i == index ? m2 : m1;
+                    o[f] = v < T(0) ? -(s * m) : s * m;
+                }
+            }
+        }
+        else {
+            // forward and backward partial min-stars, every step a batched minstar() over the lanes
+            auto lanes = [F](const T* p) { return std::span<const T>(p, F); };
+            auto out_lanes = [F](T* p) { return std::span<T>(p, F); };
+
+            std::copy(q, q + F, out + F);
+            for (size_t e = 2; e < d; ++e)
+                minstar<T>(lanes(out + (e - 1) * F), lanes(q + (e - 1) * F), out_lanes(out + e * F), config_);
+
+            T* backward = scratch;
+            std::copy(q + (d - 1) * F, q + d * F, backward);
+            for (size_t e = d - 1; e-- > 1; ) {
+                minstar<T>(lanes(out + e * F), lanes(backward), out_lanes(out + e * F), config_);
+                minstar<T>(lanes(backward), lanes(q + e * F), out_lanes(backward), config_);
+            }
+            std::copy(backward, backward + F, out);
+        }
+    }
+
+    // a lane is unsatisfied if any check sees an odd number of negative LLRs
+    std::array<bool, max_lanes> find_unsatisfied(const T* L, size_t F) const {
+        const auto& h = code_.parity_check();
+        std::array<unsigned char, max_lanes> unsatisfied{};
+        for (size_t r = 0; r < code_.checks(); ++r) {
+            std::array<unsigned char, max_lanes> parity{};
+            for (auto c: h.indices(r)) {
+                const T* l = L + size_t(c) * F;
+                for (size_t f = 0; f < F; ++f)
+                    parity[f] ^= (unsigned char)(l[f] < T(0));
+            }
+            for (size_t f = 0; f < F; ++f)
+                unsatisfied[f] |= parity[f];
+        }
+
+        std::array<bool, max_lanes> result{};
+        for (size_t f = 0; f < F; ++f)
+            result[f] = unsatisfied[f];
+        return result;
+    }
+
+    result make_result(const T* L, size_t F, size_t f, size_t iterations, bool success) const {
+        result dec_result;
+        dec_result.codeword.resize(code_.n());
+        for (size_t i = 0; i < code_.n(); ++i)
+            dec_result.codeword[i] = L[i * F + f] < T(0);
+
+        const auto& info_bits = code_.info_bits();
+        dec_result.msg.resize(info_bits.size());
+        for (size_t i = 0; i < info_bits.size(); ++i)
+            dec_result.msg[i] = dec_result.codeword[info_bits[i]];
+
+        dec_result.iterations = iterations;
+        dec_result.success = success;
+        return dec_result;
+    }
+
+    const qc_ldpc_code code_;
+    const size_t max_iterations_;
+    const minstar_config<T> config_;
+    size_t max_degree_ = 0;
+};
+
+} // namespace eccpp
+
+#endif // ECCPP_LDPC_DEC_H
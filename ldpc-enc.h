@@ -0,0 +1,44 @@
+#ifndef ECCPP_LDPC_ENC_H
+#define ECCPP_LDPC_ENC_H
+
+#include <vector>
+#include <stdexcept>
+
+#include "ldpc-code.h"
+
+namespace eccpp {
+
+//
+// systematic encoder: the k message bits are copied to code.info_bits(), every parity bit is the
+// XOR of the message bits selected by its row of code.parity_equations(), 64 bits at a time
+//
+class ldpc_enc {
+public:
+    explicit ldpc_enc(qc_ldpc_code code): code_(std::move(code)) {}
+
+    const qc_ldpc_code& code() const { return code_; }
+
+    std::vector<int> encode(const std::vector<int>& msg) const {
+        const auto& info_bits = code_.info_bits();
+        if (msg.size() != info_bits.size())
+            throw std::invalid_argument("Message size must match code dimension");
+
+        std::vector<int> result(code_.n());
+        for (size_t i = 0; i < msg.size(); ++i)
+            result[info_bits[i]] = msg[i] & 1;
+
+        // parity positions are still zero, so they don't contribute
+        const auto parity = unpack_bits(code_.parity_equations() * pack_bits(result), code_.parity_bits().size());
+        for (size_t r = 0; r < parity.size(); ++r)
+            result[code_.parity_bits()[r]] = parity[r];
+
+        return result;
+    }
+
+private:
+    const qc_ldpc_code code_;
+};
+
+} // namespace eccpp
+
+#endif // ECCPP_LDPC_ENC_H
@@ -4,6 +4,13 @@
 #include <vector>
 #include <algorithm>
 #include <memory>
+#include <cstdint>
+#include <bit>
+#include <stdexcept>
+#include <span>
+
+#include "bitpack.h"
+#include "execution.h"
 
 namespace eccpp {
 
@@ -89,6 +96,284 @@ SizeType lc_aligned_run(const std::vector<T>& a, const std::vector<T>& b) {
     return max_len;
 }
 
+//
+// bit-parallel versions of lc_run() and lc_subseq() for binary and small-alphabet sequences (up to
+// lc_max_alphabet distinct values in a and b together), same results, 64 DP cells per word
+// operation. Symbols are replaced by their rank among those values, a sequence is stored as the
+// bit planes of the ranks: plane p has bit i set if bit p of the rank of element i is 1
+//
+inline constexpr size_t lc_max_alphabet = 256;
+
+namespace detail {
+
+struct lc_symbols {
+    std::vector<std::uint8_t> a;
+    std::vector<std::uint8_t> b;
+    size_t alphabet = 0;
+};
+
+template <typename T>
+lc_symbols lc_rank_symbols(const std::vector<T>& a, const std::vector<T>& b) {
+    std::vector<T> values(a);
+    values.insert(values.end(), b.begin(), b.end());
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    if (values.size() > lc_max_alphabet)
+        throw std::invalid_argument("Too many distinct values for the bit-parallel version");
+
+    auto rank = [&](const std::vector<T>& x) {
+        std::vector<std::uint8_t> result(x.size());
+        for (size_t i = 0; i < x.size(); ++i)
+            result[i] = std::uint8_t(std::lower_bound(values.begin(), values.end(), x[i]) - values.begin());
+        return result;
+    };
+    return {rank(a), rank(b), values.size()};
+}
+
+// planes of words + 1 words each, the extra zero word lets shifted reads run past the end
+inline std::vector<std::uint64_t> lc_bit_planes(const std::vector<std::uint8_t>& ranks, size_t planes) {
+    const size_t stride = packed_words(ranks.size()) + 1;
+    std::vector<std::uint64_t> result(planes * stride);
+    for (size_t i = 0; i < ranks.size(); ++i)
+        for (size_t p = 0; p < planes; ++p)
+            result[p * stride + i / 64] |= std::uint64_t((ranks[i] >> p) & 1) << (i % 64);
+    return result;
+}
+
+// dst = src & (src >> shift), over words, src is zero past the end. GCC vectorises both loops
+inline void lc_and_shifted(const std::uint64_t* src, std::uint64_t* dst, size_t words, size_t shift) {
+    const size_t q = shift / 64;
+    const size_t r = shift % 64;
+    if (!r) {
+        ECCPP_SIMD_LOOP
+        for (size_t w = 0; w < words; ++w)
+            dst[w] = src[w] & src[w + q];
+    }
+    else {
+        ECCPP_SIMD_LOOP
+        for (size_t w = 0; w < words; ++w)
+            dst[w] = src[w] & ((src[w + q] >> r) | (src[w + q + 1] << (64 - r)));
+    }
+}
+
+// true if the bits have k >= 1 consecutive ones: after x &= x >> s with the shifts adding up to
+// k - 1, bit i survives iff bits i..i + k - 1 were all set. bits and both buffers hold at least
+// 2 * words + 1 words, zero past words
+inline bool lc_has_run(const std::uint64_t* bits, size_t words, size_t k, std::uint64_t* buffer_a, std::uint64_t* buffer_b) {
+    const std::uint64_t* src = bits;
+    std::uint64_t* dst = buffer_a;
+    for (size_t have = 1; have < k; ) {
+        const size_t shift = std::min(have, k - have);
+        lc_and_shifted(src, dst, words, shift);
+        have += shift;
+        src = dst;
+        dst = dst == buffer_a ? buffer_b : buffer_a;
+    }
+
+    std::uint64_t any = 0;
+    for (size_t w = 0; w < words; ++w)
+        any |= src[w];
+    return any != 0;
+}
+
+// true if x has k consecutive ones, k <= 64
+inline bool lc_word_has_run(std::uint64_t x, size_t k) {
+    for (size_t have = 1; have < k; ) {
+        const size_t shift = std::min(have, k - have);
+        x &= x >> shift;
+        have += shift;
+    }
+    return x != 0;
+}
+
+// longest run of ones in a stream of words, bit 0 first. A run goes on across words through their
+// trailing / leading ones, runs inside a word are only looked for when they could beat best, which
+// may start at a run found elsewhere
+struct lc_run_tracker {
+    size_t best = 0;
+    size_t current = 0;
+
+    void push(std::uint64_t x) {
+        if (x == ~std::uint64_t(0)) {
+            current += 64;
+            return;
+        }
+
+        current += size_t(std::countr_one(x));
+        best = std::max(best, current);
+        while (best < 63 && lc_word_has_run(x, best + 1))
+            ++best;
+        current = size_t(std::countl_one(x));
+    }
+
+    size_t finish() const { return std::max(best, current); }
+};
+
+// longest run of ones over the words, or best if that's longer
+inline size_t lc_longest_run(const std::uint64_t* bits, size_t words, size_t best) {
+    lc_run_tracker tracker{best};
+    for (size_t w = 0; w < words; ++w)
+        tracker.push(bits[w]);
+    return tracker.finish();
+}
+
+// longest run of equal bits in packed a and b, or best if that's longer: the ones of ~(a ^ b),
+// with the padding past bits cleared
+inline size_t lc_aligned_run_words(const std::uint64_t* a, const std::uint64_t* b, size_t bits, size_t best) {
+    const size_t words = packed_words(bits);
+    lc_run_tracker tracker{best};
+    for (size_t w = 0; w + 1 < words; ++w)
+        tracker.push(~(a[w] ^ b[w]));
+    if (words) {
+        const std::uint64_t valid = bits % 64 ? (std::uint64_t(1) << (bits % 64)) - 1 : ~std::uint64_t(0);
+        tracker.push(~(a[words - 1] ^ b[words - 1]) & valid);
+    }
+    return tracker.finish();
+}
+
+} // namespace detail
+
+// every diagonal of the DP is an aligned run of a against a shifted b (or the other way around).
+// For each of the n + m - 1 shifts the equality mask is built 64 positions at a time, and a run
+// longer than the best one so far is looked for with log2(best) shift-and passes over it. Only
+// the rare shifts that have one get scanned for their exact longest run, and the shifts whose
+// overlap is too short to have one are skipped
+template <typename T>
+size_t lc_run_bitparallel(const std::vector<T>& a, const std::vector<T>& b) {
+    const size_t n = a.size();
+    const size_t m = b.size();
+    if (!n || !m)
+        return 0;
+
+    const auto symbols = detail::lc_rank_symbols(a, b);
+    const size_t planes = std::max<size_t>(1, std::bit_width(symbols.alphabet - 1));
+    const auto pa = detail::lc_bit_planes(symbols.a, planes);
+    const auto pb = detail::lc_bit_planes(symbols.b, planes);
+    const size_t stride_a = packed_words(n) + 1;
+    const size_t stride_b = packed_words(m) + 1;
+
+    const size_t max_words = packed_words(std::min(n, m));
+    std::vector<std::uint64_t> equal(2 * max_words + 1), buffer_a(2 * max_words + 1), buffer_b(2 * max_words + 1);
+    size_t dirty = 0;
+
+    // equality of x[i] and y[offset + i], i < len
+    auto compare = [&](const std::uint64_t* x, size_t x_stride, const std::uint64_t* y, size_t y_stride,
+        size_t offset, size_t len) {
+        const size_t q = offset / 64;
+        const size_t r = offset % 64;
+        const size_t words = packed_words(len);
+        std::uint64_t* e = equal.data();
+        std::fill(e, e + words, ~std::uint64_t(0));
+        for (size_t p = 0; p < planes; ++p) {
+            const std::uint64_t* xp = x + p * x_stride;
+            const std::uint64_t* yp = y + p * y_stride + q;
+            if (!r) {
+                ECCPP_SIMD_LOOP
+                for (size_t w = 0; w < words; ++w)
+                    e[w] &= ~(xp[w] ^ yp[w]);
+            }
+            else {
+                ECCPP_SIMD_LOOP
+                for (size_t w = 0; w < words; ++w)
+                    e[w] &= ~(xp[w] ^ ((yp[w] >> r) | (yp[w + 1] << (64 - r))));
+            }
+        }
+        if (len % 64)
+            e[words - 1] &= (std::uint64_t(1) << (len % 64)) - 1;
+
+        // everything from dirty on is zero, so the shifted reads past words see zeros
+        if (dirty > words)
+            for (auto* buffer: {e, buffer_a.data(), buffer_b.data()})
+                std::fill(buffer + words, buffer + dirty, std::uint64_t(0));
+        dirty = words;
+        return words;
+    };
+
+    size_t best = 0;
+    auto diagonal = [&](const std::uint64_t* x, size_t x_stride, const std::uint64_t* y, size_t y_stride,
+        size_t offset, size_t len) {
+        const size_t words = compare(x, x_stride, y, y_stride, offset, len);
+        if (detail::lc_has_run(equal.data(), words, best + 1, buffer_a.data(), buffer_b.data()))
+            best = detail::lc_longest_run(equal.data(), words, best);
+    };
+
+    for (size_t s = 0; s < m && std::min(n, m - s) > best; ++s)
+        diagonal(pa.data(), stride_a, pb.data(), stride_b, s, std::min(n, m - s));
+    for (size_t s = 1; s < n && std::min(m, n - s) > best; ++s)
+        diagonal(pb.data(), stride_b, pa.data(), stride_a, s, std::min(m, n - s));
+
+    return best;
+}
+
+// Allison-Dix / Crochemore et al. / Hyyro: the DP row along the shorter sequence is kept as a bit
+// vector V of its horizontal differences (a 0 bit is where the row goes up by one), and every
+// element of the longer sequence updates it with one multi-word add:
+//   V' = (V + (V & M)) | (V & ~M),  M - positions of the shorter sequence matching the element
+// The LCS length is the number of zeros in V
+template <typename T>
+size_t lc_subseq_bitparallel(const std::vector<T>& a, const std::vector<T>& b) {
+    const bool a_shorter = a.size() < b.size();
+    const auto symbols = detail::lc_rank_symbols(a, b);
+    const auto& shorter = a_shorter ? symbols.a : symbols.b;
+    const auto& longer = a_shorter ? symbols.b : symbols.a;
+
+    const size_t n = shorter.size();
+    const size_t words = packed_words(n);
+    if (!n)
+        return 0;
+
+    // match masks, one per symbol
+    std::vector<std::uint64_t> match(symbols.alphabet * words);
+    for (size_t j = 0; j < n; ++j)
+        match[shorter[j] * words + j / 64] |= std::uint64_t(1) << (j % 64);
+
+    std::vector<std::uint64_t> v(words, ~std::uint64_t(0));
+    for (auto symbol: longer) {
+        const std::uint64_t* mask = match.data() + symbol * words;
+        std::uint64_t carry = 0;
+        for (size_t w = 0; w < words; ++w) {
+            const std::uint64_t x = v[w];
+            const std::uint64_t u = x & mask[w];
+            const std::uint64_t t = x + u;
+            const std::uint64_t sum = t + carry;
+            carry = std::uint64_t(t < x) | std::uint64_t(sum < t);
+            v[w] = sum | (x & ~mask[w]);
+        }
+    }
+
+    // bits past n start as ones and never see a match, a carry into them doesn't matter
+    size_t ones = 0;
+    for (size_t w = 0; w < words; ++w) {
+        const std::uint64_t valid = (w + 1 == words && n % 64) ? (std::uint64_t(1) << (n % 64)) - 1 : ~std::uint64_t(0);
+        ones += size_t(std::popcount(v[w] & valid));
+    }
+    return n - ones;
+}
+
+// lc_aligned_run() for packed binary vectors (pack_bits()) of the given number of bits, 64 positions
+// per step: the positions where a and b agree are the zeros of a ^ b, their runs are counted with
+// countr_one / countl_one and carried from word to word
+inline size_t lc_aligned_run_packed(std::span<const std::uint64_t> a, std::span<const std::uint64_t> b, size_t bits) {
+    if (a.size() != packed_words(bits) || b.size() != packed_words(bits))
+        throw std::invalid_argument("Longest common run: dimensions must match");
+
+    return detail::lc_aligned_run_words(a.data(), b.data(), bits, 0);
+}
+
+// the longest aligned run of a against any vector of a codebook: many holds the codebook's vectors
+// of packed_words(bits) words back to back. Only runs longer than the best one so far are looked
+// for inside a word
+inline size_t lc_aligned_run_packed_max(std::span<const std::uint64_t> a, std::span<const std::uint64_t> many, size_t bits) {
+    const size_t words = packed_words(bits);
+    if (a.size() != words || (words ? many.size() % words : many.size()))
+        throw std::invalid_argument("Longest common run: dimensions must match");
+
+    size_t best = 0;
+    for (size_t i = 0; words && i < many.size() / words; ++i)
+        best = detail::lc_aligned_run_words(a.data(), many.data() + i * words, bits, best);
+    return best;
+}
+
 } // namespace eccpp
 
 #endif // ECCPP_LONGEST_COMMON_H
@@ -0,0 +1,297 @@
+// binary on-disk format for mdarrays, so big precomputed tables (generator matrices, reliability
+// orderings, ...) can be stored once and mapped straight into memory at startup:
+//
+//   offset  size           field
+//   0       8              magic "ECCPPMDA"
+//   8       4              format version
+//   12      4              byte order mark 0x01020304 as written by the producer
+//   16      4              element type: kind << 8 | sizeof(T), kind 1 - signed, 2 - unsigned, 3 - float,
+//                          4 - character; bool can't be stored
+//   20      4              rank
+//   24      8              payload offset, a multiple of 64
+//   32      8              payload size in bytes
+//   40      8 * rank       dimensions
+//   ...                    zero padding
+//   payload offset         row-major elements
+//
+// mapped_mdarray maps a file read-only with mmap (MapViewOfFile on Windows), so it's a zero-copy
+// view and every process mapping the same file shares the same physical pages. The payload is
+// used as is, so files have to be produced on a machine with the same byte order.
+
+#ifndef ECCPP_MDARRAY_FILE_H
+#define ECCPP_MDARRAY_FILE_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <limits>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mdarray.h"
+
+namespace eccpp {
+
+namespace detail {
+
+inline constexpr char mdarray_file_magic[8] = {'E', 'C', 'C', 'P', 'P', 'M', 'D', 'A'};
+inline constexpr std::uint32_t mdarray_file_version = 1;
+inline constexpr std::uint32_t mdarray_file_bom = 0x01020304;
+inline constexpr size_t mdarray_file_alignment = 64;
+
+struct mdarray_file_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint32_t element_type;
+    std::uint32_t rank;
+    std::uint64_t payload_offset;
+    std::uint64_t payload_size;
+};
+static_assert(sizeof(mdarray_file_header) == 40, "Unexpected header padding");
+
+template <typename T>
+inline constexpr bool is_mdarray_file_char_v = std::is_same_v<T, char> || std::is_same_v<T, wchar_t> ||
+    std::is_same_v<T, char8_t> || std::is_same_v<T, char16_t> || std::is_same_v<T, char32_t>;
+
+// a bool payload byte other than 0 or 1 would be undefined behaviour to read, and uint8_t files
+// would otherwise load as bool, so bool isn't a storable type at all. Characters get their own
+// kind so that int8_t and char files don't mix either
+template <typename T>
+constexpr std::uint32_t mdarray_file_element_type() {
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>,
+                  "Only arithmetic element types other than bool can be stored");
+    constexpr std::uint32_t kind = std::is_floating_point_v<T> ? 3 : is_mdarray_file_char_v<T> ? 4 :
+                                   std::is_signed_v<T> ? 1 : 2;
+    return (kind << 8) | std::uint32_t(sizeof(T));
+}
+
+// validates the header and the dimensions against the file size, returns the dimensions
+template <typename T>
+std::vector<size_t> parse_mdarray_file(const unsigned char* data, size_t size, std::uint64_t& payload_offset) {
+    mdarray_file_header header;
+    if (size < sizeof(header))
+        throw std::runtime_error("mdarray file: truncated header");
+
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, mdarray_file_magic, sizeof(header.magic)))
+        throw std::runtime_error("mdarray file: bad magic");
+    if (header.version != mdarray_file_version)
+        throw std::runtime_error("mdarray file: unsupported version");
+    if (header.byte_order != mdarray_file_bom)
+        throw std::runtime_error("mdarray file: byte order mismatch");
+    if (header.element_type != mdarray_file_element_type<T>())
+        throw std::runtime_error("mdarray file: element type mismatch");
+
+    if (!header.rank || header.rank > (size - sizeof(header)) / sizeof(std::uint64_t))
+        throw std::runtime_error("mdarray file: invalid rank");
+
+    std::vector<size_t> dims(header.rank);
+    for (size_t i = 0; i < dims.size(); ++i) {
+        std::uint64_t d;
+        std::memcpy(&d, data + sizeof(header) + i * sizeof(d), sizeof(d));
+        dims[i] = size_t(d);
+    }
+
+    size_t total;
+    try {
+        total = mdarray_total_size(dims);
+    }
+    catch (const std::invalid_argument&) {
+        throw std::runtime_error("mdarray file: invalid dimensions");
+    }
+
+    const std::uint64_t dims_end = sizeof(header) + dims.size() * sizeof(std::uint64_t);
+    if (header.payload_offset % mdarray_file_alignment || header.payload_offset < dims_end ||
+        total > std::numeric_limits<size_t>::max() / sizeof(T) || header.payload_size != total * sizeof(T) ||
+        header.payload_offset > size || header.payload_size > size - header.payload_offset)
+        throw std::runtime_error("mdarray file: inconsistent payload");
+
+    payload_offset = header.payload_offset;
+    return dims;
+}
+
+} // namespace detail
+
+template <typename T, typename A>
+void save_mdarray(const std::string& path, const mdarray<T, A>& arr) {
+    const auto& dims = arr.dimensions();
+    const size_t dims_end = sizeof(detail::mdarray_file_header) + dims.size() * sizeof(std::uint64_t);
+    const size_t payload_offset = (dims_end + detail::mdarray_file_alignment - 1) / detail::mdarray_file_alignment * detail::mdarray_file_alignment;
+
+    detail::mdarray_file_header header;
+    std::memcpy(header.magic, detail::mdarray_file_magic, sizeof(header.magic));
+    header.version = detail::mdarray_file_version;
+    header.byte_order = detail::mdarray_file_bom;
+    header.element_type = detail::mdarray_file_element_type<T>();
+    header.rank = std::uint32_t(dims.size());
+    header.payload_offset = payload_offset;
+    header.payload_size = arr.size() * sizeof(T);
+
+    std::vector<unsigned char> prefix(payload_offset);
+    std::memcpy(prefix.data(), &header, sizeof(header));
+    for (size_t i = 0; i < dims.size(); ++i) {
+        const std::uint64_t d = dims[i];
+        std::memcpy(prefix.data() + sizeof(header) + i * sizeof(d), &d, sizeof(d));
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(prefix.data()), std::streamsize(prefix.size()));
+    file.write(reinterpret_cast<const char*>(arr.data()), std::streamsize(header.payload_size));
+    file.close();
+    if (!file)
+        throw std::runtime_error("mdarray file: cannot write " + path);
+}
+
+// reads the whole file into a regular (owning, writable) mdarray
+template <typename T>
+mdarray<T> load_mdarray(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        throw std::runtime_error("mdarray file: cannot open " + path);
+
+    std::vector<unsigned char> contents(size_t(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(contents.data()), std::streamsize(contents.size()));
+    if (!file)
+        throw std::runtime_error("mdarray file: cannot read " + path);
+
+    std::uint64_t payload_offset;
+    const auto dims = detail::parse_mdarray_file<T>(contents.data(), contents.size(), payload_offset);
+
+    mdarray<T> result(dims);
+    std::memcpy(result.data(), contents.data() + payload_offset, result.size() * sizeof(T));
+    return result;
+}
+
+// read-only memory mapping of a saved mdarray
+template <typename T>
+class mapped_mdarray {
+    const unsigned char* base_ = nullptr;
+    size_t mapped_size_ = 0;
+    const T* data_ = nullptr;
+    std::vector<size_t> dims_;
+
+public:
+    using value_type = T;
+
+    explicit mapped_mdarray(const std::string& path) {
+        map(path);
+        try {
+            std::uint64_t payload_offset;
+            dims_ = detail::parse_mdarray_file<T>(base_, mapped_size_, payload_offset);
+            data_ = reinterpret_cast<const T*>(base_ + payload_offset);
+        }
+        catch (...) {
+            unmap();
+            throw;
+        }
+    }
+
+    mapped_mdarray(mapped_mdarray&& other) noexcept:
+        base_(std::exchange(other.base_, nullptr)), mapped_size_(std::exchange(other.mapped_size_, 0)),
+        data_(std::exchange(other.data_, nullptr)), dims_(std::move(other.dims_)) {}
+
+    mapped_mdarray& operator=(mapped_mdarray&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            base_ = std::exchange(other.base_, nullptr);
+            mapped_size_ = std::exchange(other.mapped_size_, 0);
+            data_ = std::exchange(other.data_, nullptr);
+            dims_ = std::move(other.dims_);
+        }
+        return *this;
+    }
+
+    mapped_mdarray(const mapped_mdarray&) = delete;
+    mapped_mdarray& operator=(const mapped_mdarray&) = delete;
+
+    ~mapped_mdarray() { unmap(); }
+
+    const std::vector<size_t>& dimensions() const { return dims_; }
+    size_t size() const { return detail::mdarray_total_size(dims_); }
+    const T* data() const { return data_; }
+
+    // the view stays valid as long as the mapping lives
+    mdarray_view<const T> view() const { return mdarray_view<const T>(data_, dims_); }
+
+    // copy into a regular writable mdarray
+    mdarray<T> to_mdarray() const { return view().to_mdarray(); }
+
+private:
+    void map(const std::string& path) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            throw std::runtime_error("mdarray file: cannot open " + path);
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || !size.QuadPart) {
+            CloseHandle(file);
+            throw std::runtime_error("mdarray file: truncated header");
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!mapping)
+            throw std::runtime_error("mdarray file: cannot map " + path);
+
+        const void* base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (!base)
+            throw std::runtime_error("mdarray file: cannot map " + path);
+
+        base_ = static_cast<const unsigned char*>(base);
+        mapped_size_ = size_t(size.QuadPart);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("mdarray file: cannot open " + path);
+
+        struct stat st;
+        if (::fstat(fd, &st) || !st.st_size) {
+            ::close(fd);
+            throw std::runtime_error("mdarray file: truncated header");
+        }
+
+        void* base = ::mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (base == MAP_FAILED)
+            throw std::runtime_error("mdarray file: cannot map " + path);
+
+        base_ = static_cast<const unsigned char*>(base);
+        mapped_size_ = size_t(st.st_size);
+#endif
+    }
+
+    void unmap() {
+        if (!base_)
+            return;
+
+#ifdef _WIN32
+        UnmapViewOfFile(base_);
+#else
+        ::munmap(const_cast<unsigned char*>(base_), mapped_size_);
+#endif
+        base_ = nullptr;
+    }
+};
+
+} // namespace eccpp
+
+#endif // ECCPP_MDARRAY_FILE_H
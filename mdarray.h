@@ -4,44 +4,404 @@
 #include <vector>
 #include <stdexcept>
 #include <iostream>
+#include <utility>
+#include <type_traits>
+#include <functional>
+#include <span>
+
+#include "allocator.h"
+#include "execution.h"
+#include "gemm.h"
 
 namespace eccpp {
 
+namespace detail {
+
+// total number of elements, with the dimensions validated
+template <typename Dims>
+size_t mdarray_total_size(const Dims& dims) {
+    if (dims.empty())
+        throw std::invalid_argument("No dimensions specified");
+
+    size_t total = 1;
+    for (auto d: dims) {
+        if (!d)
+            throw std::invalid_argument("Invalid zero-size dimension");
+
+        // just in case someone tries to create a gigantic mdarray
+        // with the total size not fitting into size_t
+        const auto total_prev = total;
+        total *= d;
+        if ((total / d) != total_prev)
+            throw std::invalid_argument("Dimensions too large");
+    }
+    return total;
+}
+
+} // namespace detail
+
+// storage is 64-byte aligned by default, see allocator.h for an arena allocator for temporaries
+template <typename T, typename Alloc = aligned_allocator<T>>
+class mdarray;
+
+// Lazy element-wise expressions: A + B, A - B, -A, A * s, s * A and A / s don't compute anything,
+// they build a small expression object instead, which gets evaluated in a single fused loop once
+// it's assigned to an mdarray. So D = A + B - C reads A, B and C once and writes D once, with no
+// temporaries. When an operand is an rvalue mdarray (a temporary), its buffer is reused for the
+// result straight away instead of building an expression.
+// Expressions keep references to their mdarray operands, so avoid storing them in auto variables
+// which outlive the operands.
+struct mdarray_expr_base {};
+
+template <typename E>
+concept mdarray_expr = std::is_base_of_v<mdarray_expr_base, E>;
+
 template <typename T>
-class mdarray {
+struct is_mdarray : std::false_type {};
+
+template <typename T, typename A>
+struct is_mdarray<mdarray<T, A>> : std::true_type {};
+
+template <typename E>
+concept mdarray_operand = mdarray_expr<E> || is_mdarray<E>::value;
+
+template <typename T>
+class mdarray_view;
+
+// leaf expression referring to an existing mdarray
+template <typename T>
+class mdarray_leaf : public mdarray_expr_base {
+    const std::vector<size_t>* dims_;
+    const T* data_;
+
+public:
+    using value_type = T;
+
+    template <typename A>
+    explicit mdarray_leaf(const mdarray<T, A>& arr);
+
+    const std::vector<size_t>& dimensions() const { return *dims_; }
+    T operator[](size_t i) const { return data_[i]; }
+
+    // see mdarray_view::aliases()
+    template <typename U>
+    bool aliases(const mdarray_view<U>& dst) const;
+};
+
+template <typename T, typename A>
+mdarray_leaf<T> as_expr(const mdarray<T, A>& arr) {
+    return mdarray_leaf<T>(arr);
+}
+
+template <mdarray_expr E>
+const E& as_expr(const E& expr) {
+    return expr;
+}
+
+//
+// non-owning view of (a part of) an mdarray or any other buffer, mdspan-style: every dimension
+// has its own stride, so rows, columns, sub-blocks and transposed layouts can be referred to
+// without copying anything. A view is an element-wise expression too, so it mixes freely with
+// mdarrays in arithmetic. Views don't extend the lifetime of what they point to.
+//
+template <typename T>
+class mdarray_view : public mdarray_expr_base {
+    T* data_;
     std::vector<size_t> dims_;
-    std::vector<size_t> index_stride_;
-    std::vector<T> data_;
+    std::vector<size_t> strides_;
+    bool contiguous_ = false;
 
 public:
-    mdarray(const std::vector<size_t>& dims): dims_(dims) {
-        if (dims.empty())
-            throw std::invalid_argument("No dimensions specified");
+    using value_type = std::remove_const_t<T>;
 
-        size_t total = 1;
-        for (auto d: dims) {
-            if (!d)
-                throw std::invalid_argument("Invalid zero-size dimension");
+    // row-major contiguous buffer
+    mdarray_view(T* data, const std::vector<size_t>& dims): mdarray_view(data, dims, row_major_strides(dims)) {}
+
+    mdarray_view(T* data, const std::vector<size_t>& dims, const std::vector<size_t>& strides):
+        data_(data), dims_(dims), strides_(strides) {
+        detail::mdarray_total_size(dims_);
+        if (strides_.size() != dims_.size())
+            throw std::invalid_argument("Number of strides does not match number of dimensions");
 
-            // just in case someone tries to create a gigantic mdarray
-            // with the total size not fitting into size_t
-            const auto total_prev = total;
+        contiguous_ = (strides_ == row_major_strides(dims_));
+    }
+
+    // mutable -> const view
+    operator mdarray_view<const T>() const requires (!std::is_const_v<T>) {
+        return mdarray_view<const T>(data_, dims_, strides_);
+    }
+
+    const std::vector<size_t>& dimensions() const { return dims_; }
+    const std::vector<size_t>& strides() const { return strides_; }
+    T* data() const { return data_; }
+    bool is_contiguous() const { return contiguous_; }
+
+    // flat row-major elements, only for contiguous views
+    std::span<T> span() const {
+        if (!contiguous_)
+            throw std::invalid_argument("Cannot get a span of a non-contiguous view");
+
+        return std::span<T>(data_, size());
+    }
+
+    size_t size() const {
+        size_t total = 1;
+        for (auto d: dims_)
             total *= d;
-            if ((total / d) != total_prev)
-                throw std::invalid_argument("Dimensions too large");
+
+        return total;
+    }
+
+    T& operator()(const std::vector<size_t>& indices) const {
+        if (indices.size() != dims_.size())
+            throw std::invalid_argument("Number of indices does not match number of dimensions");
+
+        size_t off = 0;
+        for (size_t i = 0; i < indices.size(); ++i) {
+            if (indices[i] >= dims_[i])
+                throw std::invalid_argument("Index out of bounds");
+
+            off += indices[i] * strides_[i];
         }
-        data_ = std::vector<T>(total, T());
+        return data_[off];
+    }
 
-        // pre-calculate strides/offsets for faster indexing
-        index_stride_.reserve(dims.size());
-        for (auto d: dims) {
-            total /= d;
-            index_stride_.push_back(total);
+    // i-th element in row-major order (expression interface)
+    value_type operator[](size_t i) const {
+        if (contiguous_)
+            return data_[i];
+
+        size_t off = 0;
+        for (size_t d = dims_.size(); d-- > 0; ) {
+            off += (i % dims_[d]) * strides_[d];
+            i /= dims_[d];
         }
+        return data_[off];
+    }
+
+    // fixes index along axis, the result has one dimension less
+    mdarray_view slice(size_t axis, size_t index) const {
+        check_axis(axis);
+        if (dims_.size() < 2)
+            throw std::invalid_argument("Cannot slice a 1D view, use element access instead");
+        if (index >= dims_[axis])
+            throw std::invalid_argument("Index out of bounds");
+
+        auto dims = dims_;
+        auto strides = strides_;
+        dims.erase(dims.begin() + axis);
+        strides.erase(strides.begin() + axis);
+        return mdarray_view(data_ + index * strides_[axis], dims, strides);
+    }
+
+    // [begin, end) along axis
+    mdarray_view subrange(size_t axis, size_t begin, size_t end) const {
+        check_axis(axis);
+        if (begin >= end || end > dims_[axis])
+            throw std::invalid_argument("Invalid sub-range");
+
+        auto dims = dims_;
+        dims[axis] = end - begin;
+        return mdarray_view(data_ + begin * strides_[axis], dims, strides_);
+    }
+
+    // axes[i] is the source axis of the i-th output axis
+    mdarray_view permute(const std::vector<size_t>& axes) const {
+        if (axes.size() != dims_.size())
+            throw std::invalid_argument("Number of axes does not match number of dimensions");
+
+        std::vector<size_t> dims, strides;
+        std::vector<bool> used(dims_.size());
+        for (auto axis: axes) {
+            check_axis(axis);
+            if (used[axis])
+                throw std::invalid_argument("Repeated axis");
+
+            used[axis] = true;
+            dims.push_back(dims_[axis]);
+            strides.push_back(strides_[axis]);
+        }
+        return mdarray_view(data_, dims, strides);
+    }
+
+    // reversed axes, i.e. the usual matrix transpose in 2D
+    mdarray_view transpose() const {
+        return mdarray_view(data_, std::vector<size_t>(dims_.rbegin(), dims_.rend()),
+                            std::vector<size_t>(strides_.rbegin(), strides_.rend()));
+    }
+
+    // only contiguous data can be reshaped without copying
+    mdarray_view reshape(const std::vector<size_t>& dims) const {
+        if (!contiguous_)
+            throw std::invalid_argument("Cannot reshape a non-contiguous view");
+        if (detail::mdarray_total_size(dims) != size())
+            throw std::invalid_argument("Reshape must preserve the number of elements");
+
+        return mdarray_view(data_, dims);
+    }
+
+    mdarray<value_type> to_mdarray() const {
+        return mdarray<value_type>(*this);
+    }
+
+    // true if this view and dst (same dimensions) share memory, but an element of one isn't the
+    // same element of the other, e.g. a transposed view of dst. Writing dst element by element
+    // would then change elements of this view that are still to be read
+    template <typename U>
+    bool aliases(const mdarray_view<U>& dst) const {
+        const void* a = data_;
+        const void* b = dst.data();
+        if (a == b && strides_ == dst.strides())
+            return false;
+
+        auto last = [this](const auto* p, const std::vector<size_t>& strides) {
+            size_t offset = 0;
+            for (size_t d = 0; d < dims_.size(); ++d)
+                offset += (dims_[d] - 1) * strides[d];
+            return static_cast<const void*>(p + offset);
+        };
+        std::less_equal<const void*> le;
+        return le(a, last(dst.data(), dst.strides())) && le(b, last(data_, strides_));
+    }
+
+    // element-wise assignment through the view
+    template <typename E> requires mdarray_operand<E>
+    void assign(const E& expr) const {
+        static_assert(!std::is_const_v<T>, "Cannot assign through a const view");
+        if (dims_ != expr.dimensions())
+            throw std::invalid_argument("Dimension mismatch for view assignment");
+
+        if (as_expr(expr).aliases(*this)) {
+            assign(mdarray<value_type>(as_expr(expr)));
+            return;
+        }
+
+        const auto& e = as_expr(expr);
+        if (contiguous_) {
+            const size_t n = size();
+            for (size_t i = 0; i < n; ++i)
+                data_[i] = e[i];
+            return;
+        }
+
+        std::vector<size_t> indices(dims_.size(), 0);
+        T* p = data_;
+        for (size_t i = 0; ; ++i) {
+            *p = e[i];
+
+            // increment indices in row-major order
+            size_t d = dims_.size();
+            for (; d-- > 0; ) {
+                p += strides_[d];
+                if (++indices[d] < dims_[d])
+                    break;
+
+                p -= strides_[d] * dims_[d];
+                indices[d] = 0;
+            }
+            if (d == size_t(-1))
+                break;
+        }
+    }
+
+private:
+    static std::vector<size_t> row_major_strides(const std::vector<size_t>& dims) {
+        std::vector<size_t> strides(dims.size());
+        size_t stride = 1;
+        for (size_t d = dims.size(); d-- > 0; ) {
+            strides[d] = stride;
+            stride *= dims[d];
+        }
+        return strides;
+    }
+
+    void check_axis(size_t axis) const {
+        if (axis >= dims_.size())
+            throw std::invalid_argument("Axis out of range");
+    }
+};
+
+template <typename T>
+struct is_mdarray_view : std::false_type {};
+
+template <typename T>
+struct is_mdarray_view<mdarray_view<T>> : std::true_type {};
+
+// owning arrays and views, both support dimensions() and operator()(indices)
+template <typename A>
+concept mdarray_like = is_mdarray<A>::value || is_mdarray_view<A>::value;
+
+namespace detail {
+
+// flat row-major data of an mdarray or a contiguous view, nullptr for strided views.
+// Lets element-wise kernels run a single flat loop instead of walking multi-indices
+template <typename A> requires mdarray_like<A>
+auto contiguous_data(const A& a) -> decltype(a.data()) {
+    if constexpr (is_mdarray<A>::value)
+        return a.data();
+    else
+        return a.is_contiguous() ? a.data() : nullptr;
+}
+
+} // namespace detail
+
+template <typename T, typename Alloc>
+class mdarray {
+    std::vector<size_t> dims_;
+    std::vector<size_t> index_stride_;
+    std::vector<T, Alloc> data_;
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+
+    mdarray(const std::vector<size_t>& dims, const Alloc& alloc = Alloc()): dims_(dims), data_(alloc) {
+        data_.resize(init_strides());
+    }
+
+    // takes over an existing row-major buffer without copying it
+    mdarray(const std::vector<size_t>& dims, std::vector<T, Alloc>&& data): dims_(dims) {
+        if (init_strides() != data.size())
+            throw std::invalid_argument("Data size does not match dimensions");
+
+        data_ = std::move(data);
+    }
+
+    // a buffer with a different allocator has to be copied
+    template <typename A>
+    mdarray(const std::vector<size_t>& dims, const std::vector<T, A>& data, const Alloc& alloc = Alloc()): dims_(dims), data_(alloc) {
+        if (init_strides() != data.size())
+            throw std::invalid_argument("Data size does not match dimensions");
+
+        data_.assign(data.begin(), data.end());
+    }
+
+    // hands the row-major buffer over to someone else (see fixed_mdarray), leaving the array
+    // shapeless like a moved-from one
+    std::vector<T, Alloc> release() && {
+        auto data = std::move(data_);
+        data_.clear();
+        dims_.clear();
+        index_stride_.clear();
+        return data;
     }
 
+    allocator_type get_allocator() const { return data_.get_allocator(); }
+
     const std::vector<size_t>& dimensions() const { return dims_; }
 
+    // raw row-major storage
+    size_t size() const { return data_.size(); }
+    T* data() { return data_.data(); }
+    const T* data() const { return data_.data(); }
+
+    mdarray_view<T> view() { return mdarray_view<T>(data_.data(), dims_); }
+    mdarray_view<const T> view() const { return mdarray_view<const T>(data_.data(), dims_); }
+
+    // flat row-major elements
+    std::span<T> span() { return std::span<T>(data_); }
+    std::span<const T> span() const { return std::span<const T>(data_); }
+
     // access with multi-index
     T& operator()(const std::vector<size_t>& indices) {
         return data_[offset(indices)];
@@ -52,79 +412,152 @@ public:
     }
 
     // equality operators
-    friend bool operator==(const mdarray<T>& lhs, const mdarray<T>& rhs) {
+    friend bool operator==(const mdarray& lhs, const mdarray& rhs) {
         return (lhs.dims_ == rhs.dims_) && (lhs.data_ == rhs.data_);
     }
-    friend bool operator!=(const mdarray<T>& lhs, const mdarray<T>& rhs) {
+    friend bool operator!=(const mdarray& lhs, const mdarray& rhs) {
         return !(lhs == rhs);
     }
 
-    mdarray<T>& operator+=(const mdarray<T>& other) {
-        if (dims_ != other.dims_)
-            throw std::invalid_argument("Dimension mismatch for + or += operation");
+    // element-wise expressions (see mdarray_expr below) are evaluated in a single pass
+    template <mdarray_expr E>
+    mdarray(const E& expr, const Alloc& alloc = Alloc()): mdarray(expr.dimensions(), alloc) {
+        static_assert(std::is_same_v<typename E::value_type, T>, "Element type mismatch");
+        evaluate(expr, [](T& dst, const T& src) { dst = src; });
+    }
 
-        for (size_t i = 0; i < data_.size(); ++i)
-            data_[i] += other.data_[i];
+    // reuses the existing buffer when dimensions match. The destination may appear in the
+    // expression as itself, as every element only depends on the same element of the operands.
+    // Anything else reading its memory, like A = A.view().transpose(), goes through a temporary
+    template <mdarray_expr E>
+    mdarray& operator=(const E& expr) {
+        if (dims_ != expr.dimensions() || expr.aliases(std::as_const(*this).view()))
+            return (*this = mdarray(expr, data_.get_allocator()));
 
+        evaluate(expr, [](T& dst, const T& src) { dst = src; });
         return *this;
     }
-    mdarray<T>& operator-=(const mdarray<T>& other) {
-        if (dims_ != other.dims_)
-            throw std::invalid_argument("Dimension mismatch for - or -= operation");
 
-        for (size_t i = 0; i < data_.size(); ++i)
-            data_[i] -= other.data_[i];
+    template <typename E> requires mdarray_operand<E>
+    mdarray& operator+=(const E& other) {
+        if (dims_ != other.dimensions())
+            throw std::invalid_argument("Dimension mismatch for + or += operation");
 
+        evaluate_unaliased(as_expr(other), [](T& dst, const T& src) { dst += src; });
         return *this;
     }
+    template <typename E> requires mdarray_operand<E>
+    mdarray& operator-=(const E& other) {
+        if (dims_ != other.dimensions())
+            throw std::invalid_argument("Dimension mismatch for - or -= operation");
 
-    friend mdarray<T> operator+(const mdarray<T>& lhs, const mdarray<T>& rhs) {
-        mdarray<T> result = lhs;
-        return (result += rhs);
-    }
-    friend mdarray<T> operator-(const mdarray<T>& lhs, const mdarray<T>& rhs) {
-        mdarray<T> result = lhs;
-        return (result -= rhs);
-    }
-
-    // unary minus for expressions like B = -A or D = A + B - C
-    mdarray<T> operator-() const {
-        mdarray<T> result(*this);
-        for (auto& element: result.data_)
-            element = -element;
-
-        return result;
+        evaluate_unaliased(as_expr(other), [](T& dst, const T& src) { dst -= src; });
+        return *this;
     }
 
     // scalar multiplication and division
-    mdarray<T>& operator*=(const T& scalar) {
+    mdarray& operator*=(const T& scalar) {
         for (auto& element: data_)
             element *= scalar;
 
         return *this;
     }
-    mdarray<T>& operator/=(const T& scalar) {
+    mdarray& operator/=(const T& scalar) {
         for (auto& element : data_)
             element /= scalar;
 
         return *this;
     }
 
-    friend mdarray<T> operator*(const mdarray<T>& arr, const T& scalar) {
-        mdarray<T> result = arr;
-        return (result *= scalar);
+    // policy-taking versions of the element-wise operations (see execution.h), e.g.
+    // c.assign(execution::par, a + b * s) evaluates the whole fused expression across threads
+    template <execution_policy P, typename E> requires mdarray_operand<E>
+    mdarray& assign(P policy, const E& expr) {
+        // expr may read this array, so a reshaped result is built before the buffer is replaced
+        if (dims_ != expr.dimensions()) {
+            mdarray result(expr.dimensions(), data_.get_allocator());
+            result.evaluate(as_expr(expr), [](T& dst, const T& src) { dst = src; }, policy);
+            return (*this = std::move(result));
+        }
+
+        evaluate_unaliased(as_expr(expr), [](T& dst, const T& src) { dst = src; }, policy);
+        return *this;
     }
-    friend mdarray<T> operator*(const T& scalar, const mdarray<T>& arr) {
-        return arr * scalar;
+    template <execution_policy P, typename E> requires mdarray_operand<E>
+    mdarray& add(P policy, const E& other) {
+        if (dims_ != other.dimensions())
+            throw std::invalid_argument("Dimension mismatch for + or += operation");
+
+        evaluate_unaliased(as_expr(other), [](T& dst, const T& src) { dst += src; }, policy);
+        return *this;
     }
+    template <execution_policy P, typename E> requires mdarray_operand<E>
+    mdarray& subtract(P policy, const E& other) {
+        if (dims_ != other.dimensions())
+            throw std::invalid_argument("Dimension mismatch for - or -= operation");
 
-    friend mdarray<T> operator/(const mdarray<T>& arr, const T& scalar) {
-        mdarray<T> result = arr;
-        return (result /= scalar);
+        evaluate_unaliased(as_expr(other), [](T& dst, const T& src) { dst -= src; }, policy);
+        return *this;
     }
+    template <execution_policy P>
+    mdarray& multiply(P policy, const T& scalar) {
+        evaluate(as_expr(*this), [scalar](T& dst, const T&) { dst *= scalar; }, policy);
+        return *this;
+    }
+    template <execution_policy P>
+    mdarray& divide(P policy, const T& scalar) {
+        evaluate(as_expr(*this), [scalar](T& dst, const T&) { dst /= scalar; }, policy);
+        return *this;
+    }
+
+    // reductions over all elements. The summation order is a fixed tree (see execution.h), so the
+    // result doesn't depend on the policy or the number of threads
+    T sum() const { return sum(execution::seq); }
+
+    template <execution_policy P>
+    T sum(P policy) const {
+        return reduce_sum(policy, [](T x) { return x; });
+    }
+
+    T abs_sum() const { return abs_sum(execution::seq); }
 
-    // matrix multiplication / tensor contraction
-    mdarray<T> operator*(const mdarray<T>& rhs) const {
+    template <execution_policy P>
+    T abs_sum(P policy) const {
+        return reduce_sum(policy, [](T x) { return x < T() ? T(-x) : x; });
+    }
+
+    T min() const { return min(execution::seq); }
+
+    template <execution_policy P>
+    T min(P policy) const {
+        return data_[argmin(policy)];
+    }
+
+    T max() const { return max(execution::seq); }
+
+    template <execution_policy P>
+    T max(P policy) const {
+        return data_[argmax(policy)];
+    }
+
+    // row-major (flat) index of the first minimum / maximum
+    size_t argmin() const { return argmin(execution::seq); }
+
+    template <execution_policy P>
+    size_t argmin(P policy) const {
+        return arg_extremum(policy, std::less<T>());
+    }
+
+    size_t argmax() const { return argmax(execution::seq); }
+
+    template <execution_policy P>
+    size_t argmax(P policy) const {
+        return arg_extremum(policy, std::greater<T>());
+    }
+
+    // matrix multiplication / tensor contraction, the result uses the allocator of lhs
+    template <typename A>
+    mdarray operator*(const mdarray<T, A>& rhs) const {
         auto& lhs = *this;
 
         const auto& lhs_dims = lhs.dimensions();
@@ -144,7 +577,15 @@ public:
         new_dims.insert(new_dims.end(), lhs_dims.begin(), lhs_dims.end() - 1);
         new_dims.insert(new_dims.end(), rhs_dims.begin() + 1, rhs_dims.end());
 
-        mdarray<T> result(new_dims);
+        mdarray result(new_dims, data_.get_allocator());
+
+        // plain matrix product, use the blocked kernel
+        if (lhs_dims.size() == 2 && rhs_dims.size() == 2) {
+            gemm(lhs_dims[0], rhs_dims[1], contracted_dim, lhs.data_.data(), contracted_dim,
+                 rhs.data(), rhs_dims[1], result.data_.data(), rhs_dims[1]);
+            return result;
+        }
+
         std::vector<size_t> indices(new_dims.size(), 0);
         while (true) {
             // compute the sum over the contracted dimension
@@ -185,12 +626,29 @@ public:
         return result;
     }
 
-    mdarray<T>& operator*=(const mdarray<T>& rhs) {
+    template <typename A>
+    mdarray& operator*=(const mdarray<T, A>& rhs) {
         *this = *this * rhs;
         return *this;
     }
 
-    friend std::ostream& operator<<(std::ostream& os, const mdarray<T>& arr) {
+    // 2D matrix product with the row blocks split across threads
+    friend mdarray matmul(const mdarray& lhs, const mdarray& rhs, size_t threads) {
+        const auto& lhs_dims = lhs.dimensions();
+        const auto& rhs_dims = rhs.dimensions();
+        if (lhs_dims.size() != 2 || rhs_dims.size() != 2)
+            throw std::invalid_argument("matmul requires 2D matrices");
+
+        if (lhs_dims[1] != rhs_dims[0])
+            throw std::invalid_argument("Dimension mismatch for contraction");
+
+        mdarray result({lhs_dims[0], rhs_dims[1]}, lhs.data_.get_allocator());
+        gemm(lhs_dims[0], rhs_dims[1], lhs_dims[1], lhs.data_.data(), lhs_dims[1],
+             rhs.data_.data(), rhs_dims[1], result.data_.data(), rhs_dims[1], threads);
+        return result;
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const mdarray& arr) {
         const auto& dims = arr.dimensions();
         if (dims.size() == 1) {
            os << "[";
@@ -198,7 +656,7 @@ public:
                 if (i > 0)
                     os << ", ";
 
-                os << arr({i});
+                os << arr.data_[i];
             }
             os << "]\n";
         }
@@ -209,7 +667,7 @@ public:
                     if (j > 0)
                         os << ", ";
 
-                    os << arr({i, j});
+                    os << arr.data_[i * dims[1] + j];
                 }
                 os << "]\n";
             }
@@ -219,6 +677,75 @@ public:
     }
 
 private:
+    template <typename E, typename Op, execution_policy P = execution::sequenced_policy>
+    void evaluate(const E& expr, Op op, P policy = {}) {
+        T* dst = data_.data();
+        detail::for_each_range(policy, data_.size(), [&](size_t begin, size_t end) {
+            if constexpr (is_unsequenced_policy_v<P>) {
+                ECCPP_SIMD_LOOP
+                for (size_t i = begin; i < end; ++i)
+                    op(dst[i], expr[i]);
+            }
+            else {
+                for (size_t i = begin; i < end; ++i)
+                    op(dst[i], expr[i]);
+            }
+        });
+    }
+
+    // evaluate(), with expressions that read this array through another layout (see
+    // mdarray_view::aliases()) copied to a temporary first
+    template <typename E, typename Op, execution_policy P = execution::sequenced_policy>
+    void evaluate_unaliased(const E& expr, Op op, P policy = {}) {
+        if (!expr.aliases(std::as_const(*this).view())) {
+            evaluate(expr, op, policy);
+            return;
+        }
+
+        mdarray copy(dims_, data_.get_allocator());
+        copy.evaluate(expr, [](T& dst, const T& src) { dst = src; }, policy);
+        evaluate(as_expr(copy), op, policy);
+    }
+
+    template <execution_policy P, typename F>
+    T reduce_sum(P policy, F f) const {
+        const T* src = data_.data();
+        return detail::tree_reduce<P, T>(policy, data_.size(), [src, f](size_t begin, size_t end) {
+            return detail::lane_sum<is_unsequenced_policy_v<P>>(src + begin, end - begin, f);
+        }, [](T lhs, T rhs) { return T(lhs + rhs); });
+    }
+
+    // ties go to the lower index: lhs always covers lower indices than rhs when combining
+    template <execution_policy P, typename Better>
+    size_t arg_extremum(P policy, Better better) const {
+        // moved-from and released arrays have no elements to pick from
+        if (data_.empty())
+            throw std::invalid_argument("Empty mdarray has no minimum or maximum");
+
+        const T* src = data_.data();
+        return detail::tree_reduce<P, size_t>(policy, data_.size(), [src, better](size_t begin, size_t end) {
+            size_t best = begin;
+            for (size_t i = begin + 1; i < end; ++i)
+                if (better(src[i], src[best]))
+                    best = i;
+
+            return best;
+        }, [src, better](size_t lhs, size_t rhs) { return better(src[rhs], src[lhs]) ? rhs : lhs; });
+    }
+
+    size_t init_strides() {
+        size_t total = detail::mdarray_total_size(dims_);
+        const size_t result = total;
+
+        // pre-calculate strides/offsets for faster indexing
+        index_stride_.reserve(dims_.size());
+        for (auto d: dims_) {
+            total /= d;
+            index_stride_.push_back(total);
+        }
+        return result;
+    }
+
     size_t offset(const std::vector<size_t>& indices) const {
         if (indices.size() != dims_.size())
             throw std::invalid_argument("Number of indices does not match number of dimensions");
@@ -235,6 +762,178 @@ private:
     }
 };
 
+template <typename T>
+template <typename A>
+mdarray_leaf<T>::mdarray_leaf(const mdarray<T, A>& arr): dims_(&arr.dimensions()), data_(arr.data()) {}
+
+template <typename T>
+template <typename U>
+bool mdarray_leaf<T>::aliases(const mdarray_view<U>& dst) const {
+    return mdarray_view<const T>(data_, *dims_).aliases(dst);
+}
+
+template <typename L, typename R, typename Op>
+class mdarray_binary_expr : public mdarray_expr_base {
+    L lhs_;
+    R rhs_;
+
+public:
+    using value_type = typename L::value_type;
+    static_assert(std::is_same_v<value_type, typename R::value_type>, "Element type mismatch");
+
+    mdarray_binary_expr(const L& lhs, const R& rhs): lhs_(lhs), rhs_(rhs) {
+        if (lhs.dimensions() != rhs.dimensions())
+            throw std::invalid_argument("Dimension mismatch for element-wise operation");
+    }
+
+    const std::vector<size_t>& dimensions() const { return lhs_.dimensions(); }
+    value_type operator[](size_t i) const { return Op()(lhs_[i], rhs_[i]); }
+
+    template <typename U>
+    bool aliases(const mdarray_view<U>& dst) const { return lhs_.aliases(dst) || rhs_.aliases(dst); }
+};
+
+template <typename E, typename Op>
+class mdarray_scalar_expr : public mdarray_expr_base {
+public:
+    using value_type = typename E::value_type;
+
+private:
+    E expr_;
+    value_type scalar_;
+
+public:
+    mdarray_scalar_expr(const E& expr, const value_type& scalar): expr_(expr), scalar_(scalar) {}
+
+    const std::vector<size_t>& dimensions() const { return expr_.dimensions(); }
+    value_type operator[](size_t i) const { return Op()(expr_[i], scalar_); }
+
+    template <typename U>
+    bool aliases(const mdarray_view<U>& dst) const { return expr_.aliases(dst); }
+};
+
+template <typename E>
+class mdarray_negate_expr : public mdarray_expr_base {
+    E expr_;
+
+public:
+    using value_type = typename E::value_type;
+
+    explicit mdarray_negate_expr(const E& expr): expr_(expr) {}
+
+    const std::vector<size_t>& dimensions() const { return expr_.dimensions(); }
+    value_type operator[](size_t i) const { return -expr_[i]; }
+
+    template <typename U>
+    bool aliases(const mdarray_view<U>& dst) const { return expr_.aliases(dst); }
+};
+
+template <typename E>
+using mdarray_expr_t = std::decay_t<decltype(as_expr(std::declval<const E&>()))>;
+
+template <typename E>
+using mdarray_value_t = typename mdarray_expr_t<E>::value_type;
+
+// lazy versions
+
+template <typename L, typename R> requires mdarray_operand<L> && mdarray_operand<R>
+auto operator+(const L& lhs, const R& rhs) {
+    return mdarray_binary_expr<mdarray_expr_t<L>, mdarray_expr_t<R>, std::plus<>>(as_expr(lhs), as_expr(rhs));
+}
+
+template <typename L, typename R> requires mdarray_operand<L> && mdarray_operand<R>
+auto operator-(const L& lhs, const R& rhs) {
+    return mdarray_binary_expr<mdarray_expr_t<L>, mdarray_expr_t<R>, std::minus<>>(as_expr(lhs), as_expr(rhs));
+}
+
+template <typename E> requires mdarray_operand<E>
+auto operator-(const E& expr) {
+    return mdarray_negate_expr<mdarray_expr_t<E>>(as_expr(expr));
+}
+
+template <typename E> requires mdarray_operand<E>
+auto operator*(const E& expr, const mdarray_value_t<E>& scalar) {
+    return mdarray_scalar_expr<mdarray_expr_t<E>, std::multiplies<>>(as_expr(expr), scalar);
+}
+
+template <typename E> requires mdarray_operand<E>
+auto operator*(const mdarray_value_t<E>& scalar, const E& expr) {
+    return expr * scalar;
+}
+
+template <typename E> requires mdarray_operand<E>
+auto operator/(const E& expr, const mdarray_value_t<E>& scalar) {
+    return mdarray_scalar_expr<mdarray_expr_t<E>, std::divides<>>(as_expr(expr), scalar);
+}
+
+// contraction of an expression with something else needs it evaluated first
+template <mdarray_expr L, typename R> requires mdarray_operand<R>
+auto operator*(const L& lhs, const R& rhs) {
+    return mdarray<typename L::value_type>(lhs) * rhs;
+}
+
+// versions reusing a temporary's buffer
+
+template <typename T, typename A, typename R> requires mdarray_operand<R>
+mdarray<T, A> operator+(mdarray<T, A>&& lhs, const R& rhs) {
+    lhs += rhs;
+    return std::move(lhs);
+}
+
+template <typename L, typename T, typename A> requires mdarray_operand<L>
+mdarray<T, A> operator+(const L& lhs, mdarray<T, A>&& rhs) {
+    rhs += lhs;
+    return std::move(rhs);
+}
+
+template <typename T, typename A>
+mdarray<T, A> operator+(mdarray<T, A>&& lhs, mdarray<T, A>&& rhs) {
+    lhs += rhs;
+    return std::move(lhs);
+}
+
+template <typename T, typename A, typename R> requires mdarray_operand<R>
+mdarray<T, A> operator-(mdarray<T, A>&& lhs, const R& rhs) {
+    lhs -= rhs;
+    return std::move(lhs);
+}
+
+template <typename L, typename T, typename A> requires mdarray_operand<L>
+mdarray<T, A> operator-(const L& lhs, mdarray<T, A>&& rhs) {
+    rhs = lhs - rhs;
+    return std::move(rhs);
+}
+
+template <typename T, typename A>
+mdarray<T, A> operator-(mdarray<T, A>&& lhs, mdarray<T, A>&& rhs) {
+    lhs -= rhs;
+    return std::move(lhs);
+}
+
+template <typename T, typename A>
+mdarray<T, A> operator-(mdarray<T, A>&& arr) {
+    arr = -arr;
+    return std::move(arr);
+}
+
+template <typename T, typename A>
+mdarray<T, A> operator*(mdarray<T, A>&& arr, const std::type_identity_t<T>& scalar) {
+    arr *= scalar;
+    return std::move(arr);
+}
+
+template <typename T, typename A>
+mdarray<T, A> operator*(const std::type_identity_t<T>& scalar, mdarray<T, A>&& arr) {
+    arr *= scalar;
+    return std::move(arr);
+}
+
+template <typename T, typename A>
+mdarray<T, A> operator/(mdarray<T, A>&& arr, const std::type_identity_t<T>& scalar) {
+    arr /= scalar;
+    return std::move(arr);
+}
+
 } // namespace eccpp
 
 #endif // ECCPP_MDARRAY_H
@@ -5,8 +5,22 @@
 
 #include <cmath>
 #include <algorithm>
+#include <array>
+#include <span>
+#include <limits>
+#include <stdexcept>
 
 #include "sign.h"
+#include "execution.h"
+
+// the batched kernels are also built for AVX2 and AVX-512 and picked at runtime, as in bitpack.h
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define ECCPP_MINSTAR_DISPATCH 1
+#define ECCPP_TARGET(isa) __attribute__((target(isa)))
+#define ECCPP_ALWAYS_INLINE __attribute__((always_inline))
+#else
+#define ECCPP_ALWAYS_INLINE
+#endif
 
 namespace eccpp {
 
@@ -18,6 +32,344 @@ T minstar(T a, T b, bool approx) {
     return 2 * std::atanh(std::tanh(a / 2) * std::tanh(b / 2));
 }
 
+//
+// batched min-star (boxplus) over arrays. With m = min(|a|, |b|), M = max(|a|, |b|):
+//   a [+] b = sign(a) sign(b) (m + c(M + m) - c(M - m)),  c(t) = log(1 + exp(-t))
+// which is the same as 2 atanh(tanh(a/2) tanh(b/2)), without overflowing and with no atanh.
+// sign() is MATLAB's, so a zero input gives a zero result and NaN propagates
+//
+enum class minstar_mode {
+    exact,              // c() evaluated with log1p / exp
+    jacobian_lut,       // c() from a 32-entry table, 0.25 apart
+    offset_min_sum,     // sign(a) sign(b) max(m - offset, 0)
+    normalized_min_sum  // sign(a) sign(b) scale * m, the same as minstar(a, b, true) for scale = 1
+};
+
+template <typename T>
+struct minstar_config {
+    minstar_mode mode = minstar_mode::exact;
+    T offset = T(0.5);
+    T scale = T(0.75);
+};
+
+namespace detail {
+
+inline constexpr size_t minstar_lut_size = 32;
+inline constexpr double minstar_lut_step = 0.25;
+
+// c(t) sampled at the middle of every step, the last entry covers everything beyond
+template <typename T>
+const std::array<T, minstar_lut_size>& minstar_lut() {
+    static const auto lut = [] {
+        std::array<T, minstar_lut_size> result;
+        for (size_t i = 0; i < minstar_lut_size; ++i)
+            result[i] = T(std::log1p(std::exp(-(double(i) + 0.5) * minstar_lut_step)));
+        result.back() = T(0);
+        return result;
+    }();
+    return lut;
+}
+
+// branch-free MATLAB sign()
+template <typename T>
+inline T sign_nan(T x) {
+    return x != x ? x : T(x > T(0)) - T(x < T(0));
+}
+
+template <minstar_mode Mode, typename T>
+inline T minstar_magnitude(T m, T M, T offset, T scale, const T* lut) {
+    if constexpr (Mode == minstar_mode::offset_min_sum) {
+        const T r = m - offset;
+        return r < T(0) ? T(0) : r;
+    }
+    else if constexpr (Mode == minstar_mode::normalized_min_sum)
+        return scale * m;
+    else {
+        // inf - inf would poison the correction, c(0) is the right value there
+        T d = M - m;
+        d = d == d ? d : T(0);
+        const T s = M + m;
+
+        if constexpr (Mode == minstar_mode::exact)
+            return m + std::log1p(std::exp(-s)) - std::log1p(std::exp(-d));
+        else {
+            constexpr T last = T(minstar_lut_size - 1);
+            T is = s * T(1 / minstar_lut_step);
+            T id = d * T(1 / minstar_lut_step);
+            is = is < last ? is : last;
+            id = id < last ? id : last;
+
+            // the table is coarse, so it could overshoot m
+            const T r = m + lut[size_t(is)] - lut[size_t(id)];
+            return r < T(0) ? T(0) : r;
+        }
+    }
+}
+
+template <minstar_mode Mode, typename T>
+inline T minstar_pair(T x, T y, T offset, T scale, const T* lut) {
+    const T ax = std::abs(x);
+    const T ay = std::abs(y);
+    const T m = ax < ay ? ax : ay;
+    const T M = ax < ay ? ay : ax;
+
+    return sign_nan(x) * sign_nan(y) * minstar_magnitude<Mode>(m, M, offset, scale, lut);
+}
+
+// the body of every minstar_pairwise_*() kernel, compiled for each instruction set separately
+template <minstar_mode Mode, typename T>
+ECCPP_ALWAYS_INLINE inline void minstar_pairwise(const T* a, const T* b, T* out, size_t n, T offset, T scale) {
+    if constexpr (Mode == minstar_mode::jacobian_lut) {
+        const T* lut = minstar_lut<T>().data();
+
+        // GCC won't if-convert the index clamps when more arithmetic depends on them, so the
+        // clamped table positions go through small buffers and both passes vectorise (the
+        // second one with gathers on AVX2 / AVX-512). inf - inf lands on the last entry, which
+        // is fine as m is infinite then
+        constexpr size_t chunk = 256;
+        constexpr T last = T(minstar_lut_size - 1);
+        T pos_sum[chunk];
+        T pos_diff[chunk];
+        for (size_t begin = 0; begin < n; begin += chunk) {
+            const size_t len = std::min(chunk, n - begin);
+            const T* x = a + begin;
+            const T* y = b + begin;
+
+            ECCPP_SIMD_LOOP
+            for (size_t i = 0; i < len; ++i) {
+                const T ax = std::abs(x[i]);
+                const T ay = std::abs(y[i]);
+                const T ps = (ax + ay) * T(1 / minstar_lut_step);
+                const T pd = std::abs(ax - ay) * T(1 / minstar_lut_step);
+                pos_sum[i] = ps < last ? ps : last;
+                pos_diff[i] = pd < last ? pd : last;
+            }
+
+            T* o = out + begin;
+            ECCPP_SIMD_LOOP
+            for (size_t i = 0; i < len; ++i) {
+                const T ax = std::abs(x[i]);
+                const T ay = std::abs(y[i]);
+                const T m = ax < ay ? ax : ay;
+                const T r = m + lut[int(pos_sum[i])] - lut[int(pos_diff[i])];
+                o[i] = sign_nan(x[i]) * sign_nan(y[i]) * (r < T(0) ? T(0) : r);
+            }
+        }
+        return;
+    }
+
+    if constexpr (Mode == minstar_mode::exact) {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = minstar_pair<Mode>(a[i], b[i], offset, scale, static_cast<const T*>(nullptr));
+        return;
+    }
+
+    // both min-sum modes are s * max(k * m - o, 0). Written out rather than through minstar_pair(),
+    // which isn't always inlined early enough for the selects to be if-converted
+    const T k = Mode == minstar_mode::normalized_min_sum ? scale : T(1);
+    const T o = Mode == minstar_mode::normalized_min_sum ? T(0) : offset;
+
+    ECCPP_SIMD_LOOP
+    for (size_t i = 0; i < n; ++i) {
+        const T x = a[i];
+        const T y = b[i];
+        const T ax = std::abs(x);
+        const T ay = std::abs(y);
+        const T m = ax < ay ? ax : ay;
+        const T s = (x != x ? x : T(x > T(0)) - T(x < T(0))) * (y != y ? y : T(y > T(0)) - T(y < T(0)));
+        const T r = k * m - o;
+        out[i] = s * (r < T(0) ? T(0) : r);
+    }
+}
+
+// minstar_pairwise() implementations, minstar_isa_supported() tells which ones the CPU can run
+enum class minstar_isa {
+    generic,    // whatever the compiler flags allow, SSE2 by default on x86-64
+    avx2,       // 8 floats per operation, gathers for the table lookups
+    avx512      // 16 floats per operation
+};
+
+template <typename T>
+using minstar_kernel = void (*)(const T*, const T*, T*, size_t, T, T);
+
+template <minstar_mode Mode, typename T>
+void minstar_pairwise_generic(const T* a, const T* b, T* out, size_t n, T offset, T scale) {
+    minstar_pairwise<Mode>(a, b, out, n, offset, scale);
+}
+
+#if defined(ECCPP_MINSTAR_DISPATCH)
+
+template <minstar_mode Mode, typename T>
+ECCPP_TARGET("avx2") void minstar_pairwise_avx2(const T* a, const T* b, T* out, size_t n, T offset, T scale) {
+    minstar_pairwise<Mode>(a, b, out, n, offset, scale);
+}
+
+template <minstar_mode Mode, typename T>
+ECCPP_TARGET("avx512f") void minstar_pairwise_avx512(const T* a, const T* b, T* out, size_t n, T offset, T scale) {
+    minstar_pairwise<Mode>(a, b, out, n, offset, scale);
+}
+
+#endif
+
+inline bool minstar_isa_supported(minstar_isa isa) {
+#if defined(ECCPP_MINSTAR_DISPATCH)
+    __builtin_cpu_init();
+    switch (isa) {
+    case minstar_isa::generic:
+        return true;
+    case minstar_isa::avx2:
+        return __builtin_cpu_supports("avx2");
+    case minstar_isa::avx512:
+        return __builtin_cpu_supports("avx512f");
+    }
+    return false;
+#else
+    return isa == minstar_isa::generic;
+#endif
+}
+
+// the kernel for isa, which must be supported
+template <minstar_mode Mode, typename T>
+minstar_kernel<T> minstar_pairwise_kernel(minstar_isa isa) {
+    switch (isa) {
+#if defined(ECCPP_MINSTAR_DISPATCH)
+    case minstar_isa::avx2:
+        return minstar_pairwise_avx2<Mode, T>;
+    case minstar_isa::avx512:
+        return minstar_pairwise_avx512<Mode, T>;
+#endif
+    default:
+        return minstar_pairwise_generic<Mode, T>;
+    }
+}
+
+inline minstar_isa minstar_best_isa() {
+    for (auto isa: {minstar_isa::avx512, minstar_isa::avx2})
+        if (minstar_isa_supported(isa))
+            return isa;
+    return minstar_isa::generic;
+}
+
+// the best kernel for the CPU, looked up on the first call
+template <minstar_mode Mode, typename T>
+inline void minstar_pairwise_best(const T* a, const T* b, T* out, size_t n, T offset, T scale) {
+    static const minstar_kernel<T> kernel = minstar_pairwise_kernel<Mode, T>(minstar_best_isa());
+    kernel(a, b, out, n, offset, scale);
+}
+
+// leave-one-out with forward and backward partial min-stars, 3n operations
+template <minstar_mode Mode, typename T>
+void minstar_extrinsic_fb(const T* in, T* out, size_t n, T offset, T scale) {
+    const T* lut = minstar_lut<T>().data();
+
+    // out[i] = in[0] [+] ... [+] in[i - 1] first, then combined with a running backward part
+    out[1] = in[0];
+    for (size_t i = 2; i < n; ++i)
+        out[i] = minstar_pair<Mode>(out[i - 1], in[i - 1], offset, scale, lut);
+
+    T backward = in[n - 1];
+    for (size_t i = n - 1; i-- > 1; ) {
+        out[i] = minstar_pair<Mode>(out[i], backward, offset, scale, lut);
+        backward = minstar_pair<Mode>(backward, in[i], offset, scale, lut);
+    }
+    out[0] = backward;
+}
+
+// leave-one-out over a row with the two smallest magnitudes: every output gets min1 except the
+// one that had it, which gets min2
+template <minstar_mode Mode, typename T>
+void minstar_extrinsic_min_sum(const T* in, T* out, size_t n, T offset, T scale) {
+    // product of the signs of the non-zero inputs, zeros show up as a zero magnitude instead
+    T sign_product = T(1);
+    T min1 = std::numeric_limits<T>::infinity();
+    T min2 = min1;
+    size_t min1_index = 0;
+    size_t nans = 0;
+    size_t nan_index = 0;
+
+    // branch-free, the comparisons are data dependent and mispredict a lot. A NaN counts as an
+    // infinite magnitude so it never becomes a minimum, and x < 0 is false for it
+    for (size_t i = 0; i < n; ++i) {
+        const T x = in[i];
+        const bool nan = x != x;
+        nans += nan;
+        nan_index = nan ? i : nan_index;
+
+        const T ax = nan ? std::numeric_limits<T>::infinity() : std::abs(x);
+        const bool smallest = ax < min1;
+        sign_product = x < T(0) ? -sign_product : sign_product;
+        min2 = smallest ? min1 : (ax < min2 ? ax : min2);
+        min1_index = smallest ? i : min1_index;
+        min1 = smallest ? ax : min1;
+    }
+
+    const T mag1 = minstar_magnitude<Mode>(min1, min1, offset, scale, static_cast<const T*>(nullptr));
+    const T mag2 = minstar_magnitude<Mode>(min2, min2, offset, scale, static_cast<const T*>(nullptr));
+    const T nan = std::numeric_limits<T>::quiet_NaN();
+
+    for (size_t i = 0; i < n; ++i) {
+        const T own_sign = in[i] < T(0) ? T(-1) : T(1);
+        const T mag = i == min1_index ? mag2 : mag1;
+        const bool other_nan = nans > 1 || (nans == 1 && i != nan_index);
+        out[i] = other_nan ? nan : sign_product * own_sign * mag;
+    }
+
+    // a NaN input has no sign to take out of the product
+    if (nans == 1)
+        out[nan_index] = sign_product * (nan_index == min1_index ? mag2 : mag1);
+}
+
+} // namespace detail
+
+// out[i] = a[i] [+] b[i]. out may alias a or b
+template <typename T>
+void minstar(std::span<const T> a, std::span<const T> b, std::span<T> out, const minstar_config<T>& config = {}) {
+    if (a.size() != b.size() || a.size() != out.size())
+        throw std::invalid_argument("minstar: Input sizes must be identical.");
+
+    // exact mode is log1p / exp calls either way, there's nothing for wider vectors to do
+    const size_t n = a.size();
+    if (config.mode == minstar_mode::exact)
+        detail::minstar_pairwise<minstar_mode::exact>(a.data(), b.data(), out.data(), n, config.offset, config.scale);
+    else if (config.mode == minstar_mode::jacobian_lut)
+        detail::minstar_pairwise_best<minstar_mode::jacobian_lut>(a.data(), b.data(), out.data(), n, config.offset, config.scale);
+    else if (config.mode == minstar_mode::offset_min_sum)
+        detail::minstar_pairwise_best<minstar_mode::offset_min_sum>(a.data(), b.data(), out.data(), n, config.offset, config.scale);
+    else
+        detail::minstar_pairwise_best<minstar_mode::normalized_min_sum>(a.data(), b.data(), out.data(), n, config.offset, config.scale);
+}
+
+// check node update: out[i] is the min-star of every input but in[i]. The min-sum modes use the
+// min1 / min2 reduction, the others forward and backward partial min-stars. A single input has
+// nothing to combine with, so its output is NaN. out must not alias in
+template <typename T>
+void minstar_extrinsic(std::span<const T> in, std::span<T> out, const minstar_config<T>& config = {}) {
+    if (in.size() != out.size())
+        throw std::invalid_argument("minstar: Input sizes must be identical.");
+
+    const size_t n = in.size();
+    if (n < 2) {
+        if (n)
+            out[0] = std::numeric_limits<T>::quiet_NaN();
+        return;
+    }
+
+    switch (config.mode) {
+    case minstar_mode::exact:
+        detail::minstar_extrinsic_fb<minstar_mode::exact>(in.data(), out.data(), n, config.offset, config.scale);
+        break;
+    case minstar_mode::jacobian_lut:
+        detail::minstar_extrinsic_fb<minstar_mode::jacobian_lut>(in.data(), out.data(), n, config.offset, config.scale);
+        break;
+    case minstar_mode::offset_min_sum:
+        detail::minstar_extrinsic_min_sum<minstar_mode::offset_min_sum>(in.data(), out.data(), n, config.offset, config.scale);
+        break;
+    case minstar_mode::normalized_min_sum:
+        detail::minstar_extrinsic_min_sum<minstar_mode::normalized_min_sum>(in.data(), out.data(), n, config.offset, config.scale);
+        break;
+    }
+}
+
 } // namespace eccpp
 
 #endif // ECCPP_MINSTAR_H
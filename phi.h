@@ -6,20 +6,165 @@
 
 #include <cmath>
 #include <algorithm>
+#include <span>
 
 #include "mdarray.h"
 #include "sign.h"
 
 namespace eccpp {
 
+// how phi() / phi_inplace() evaluate the path metric increment log(1 + exp(x)), x = -(1 - 2u_i)L_i
+enum class phi_mode {
+    exact,          // stable softplus max(0, x) + log1p(exp(-|x|)), no overflow for large |L_i|
+    fast,           // max(0, x) + a polynomial for log1p(exp(-|x|)), absolute error below 6e-4
+    approx_minstar  // max(0, x) only, i.e. |L_i| when the hard decision on L_i disagrees with u_i
+};
+
+namespace detail {
+
+// log1p(exp(-t)) for t in [0, 7]: degree 6 minimax fit, the value at 7 is used beyond
+template <typename T>
+T softplus_correction_poly(T t) {
+    return T(0.6936814525629357) + t * (T(-0.5078984979501276) + t * (T(0.14368374769865827) + t * (T(-0.01534042739448143) +
+           t * (T(-0.0006801511283656802) + t * (T(0.00027114589488663987) + t * T(-1.5647034891670947e-05))))));
+}
+
+template <typename T>
+T softplus(T x) {
+    return (x < T(0) ? T(0) : x) + std::log1p(std::exp(-std::abs(x)));
+}
+
+// PM[i] += softplus((2u - 1) * L[i]) over one path. Branch-free, so the fast and approx_minstar
+// loops vectorise; x < 0 ? 0 : x rather than std::max keeps NaN LLRs visible in the metric
+template <phi_mode Mode, typename T>
+void phi_row(T* PM, const T* L, size_t n, T u) {
+    const T scale = T(2) * u - T(1);
+
+    if constexpr (Mode == phi_mode::fast) {
+        // GCC won't if-convert the clamp when the polynomial depends on it (-ftrapping-math),
+        // so the clamped |x| goes through a small buffer and both passes vectorise
+        constexpr size_t chunk = 256;
+        T t[chunk];
+        for (size_t begin = 0; begin < n; begin += chunk) {
+            const size_t len = std::min(chunk, n - begin);
+            const T* l = L + begin;
+            T* pm = PM + begin;
+
+            ECCPP_SIMD_LOOP
+            for (size_t i = 0; i < len; ++i) {
+                const T a = std::abs(scale * l[i]);
+                t[i] = a < T(7) ? a : T(7);
+            }
+
+            ECCPP_SIMD_LOOP
+            for (size_t i = 0; i < len; ++i) {
+                const T x = scale * l[i];
+                pm[i] += (x < T(0) ? T(0) : x) + softplus_correction_poly(t[i]);
+            }
+        }
+        return;
+    }
+
+    ECCPP_SIMD_LOOP
+    for (size_t i = 0; i < n; ++i) {
+        const T x = scale * L[i];
+        const T relu = x < T(0) ? T(0) : x;
+
+        if constexpr (Mode == phi_mode::approx_minstar)
+            PM[i] += relu;
+        else
+            PM[i] += relu + std::log1p(std::exp(-std::abs(x)));
+    }
+}
+
+} // namespace detail
+
+// in-place path metric update for a whole list: PM and L are paths x elements, row-major, and
+// u holds the decision of every path. u values must be 0 or 1
 template <typename T>
-mdarray<T> phi(const mdarray<T>& PM_iminus1, const mdarray<T>& L_i, const T u_i, bool approx_minstar) {
+void phi_inplace(T* PM, const T* L, const T* u, size_t paths, size_t elements, phi_mode mode) {
+    for (size_t l = 0; l < paths; ++l) {
+        T* pm = PM + l * elements;
+        const T* llr = L + l * elements;
+
+        switch (mode) {
+        case phi_mode::exact:
+            detail::phi_row<phi_mode::exact>(pm, llr, elements, u[l]);
+            break;
+        case phi_mode::fast:
+            detail::phi_row<phi_mode::fast>(pm, llr, elements, u[l]);
+            break;
+        case phi_mode::approx_minstar:
+            detail::phi_row<phi_mode::approx_minstar>(pm, llr, elements, u[l]);
+            break;
+        }
+    }
+}
+
+// PM_i and L_i have the same dimensions, the first one is the path index and u_i has one
+// decision per path. Strided L_i views are copied first
+template <typename T, typename A, typename L> requires mdarray_like<L>
+void phi_inplace(mdarray<T, A>& PM_i, const L& L_i, std::span<const T> u_i, phi_mode mode) {
+    if (PM_i.dimensions() != L_i.dimensions())
+        throw std::invalid_argument("phi: Input dimensions must be identical.");
+
+    const size_t paths = PM_i.dimensions()[0];
+    if (u_i.size() != paths)
+        throw std::invalid_argument("phi: One decision per path required.");
+
+    if (const T* L_data = detail::contiguous_data(L_i))
+        phi_inplace(PM_i.data(), L_data, u_i.data(), paths, PM_i.size() / paths, mode);
+    else if constexpr (!is_mdarray<L>::value) {
+        const auto dense = L_i.to_mdarray();
+        phi_inplace(PM_i.data(), dense.data(), u_i.data(), paths, PM_i.size() / paths, mode);
+    }
+}
+
+// single decision for every element
+template <typename T, typename A, typename L> requires mdarray_like<L>
+void phi_inplace(mdarray<T, A>& PM_i, const L& L_i, const std::type_identity_t<T> u_i, phi_mode mode) {
+    if (PM_i.dimensions() != L_i.dimensions())
+        throw std::invalid_argument("phi: Input dimensions must be identical.");
+
+    if (const T* L_data = detail::contiguous_data(L_i))
+        phi_inplace(PM_i.data(), L_data, &u_i, 1, PM_i.size(), mode);
+    else if constexpr (!is_mdarray<L>::value) {
+        const auto dense = L_i.to_mdarray();
+        phi_inplace(PM_i.data(), dense.data(), &u_i, 1, PM_i.size(), mode);
+    }
+}
+
+// PM_iminus1 and L_i can be mdarrays or views. The result has the same type (and allocator)
+// as PM_iminus1 when that's an mdarray, or is a default mdarray for views
+template <typename P, typename L, typename T = typename P::value_type,
+          typename R = std::conditional_t<is_mdarray<P>::value, P, mdarray<T>>> requires mdarray_like<P> && mdarray_like<L>
+R phi(const P& PM_iminus1, const L& L_i, const std::type_identity_t<T> u_i, bool approx_minstar) {
     // Check if all input dimensions match
     if (PM_iminus1.dimensions() != L_i.dimensions())
         throw std::invalid_argument("phi: Input dimensions must be identical.");
 
     // Initialize PM_i as a copy of PM_iminus1
-    mdarray<T> PM_i(PM_iminus1);
+    R PM_i = PM_iminus1;
+
+    // contiguous L_i: flat branch-free loops over the row-major data, which the compiler vectorises
+    if (const auto* L_data = detail::contiguous_data(L_i)) {
+        T* PM = PM_i.data();
+        const size_t n = PM_i.size();
+
+        if (approx_minstar) {
+            for (size_t i = 0; i < n; ++i) {
+                // same as 0.5 * (1 - sign(L)) != u_i, without the branches of sign()
+                const T L_val = L_data[i];
+                const T s = T(L_val > 0) - T(L_val < 0);
+                const bool update = (T(0.5) * (T(1) - s) != u_i) || (L_val != L_val);
+                PM[i] += update ? std::abs(L_val) : T(0);
+            }
+        }
+        else
+            detail::phi_row<phi_mode::exact>(PM, L_data, n, u_i);
+
+        return PM_i;
+    }
 
     // Get dimensions to iterate over all elements
     const auto& dims = PM_i.dimensions();
@@ -60,7 +205,7 @@ mdarray<T> phi(const mdarray<T>& PM_iminus1, const mdarray<T>& L_i, const T u_i,
 
             // Compute log(1 + exp(-(1 - 2u_i)L_i))
             const T exponent = -(1.0 - 2.0 * u_i) * L_val;
-            PM_i(indices) += std::log(1.0 + std::exp(exponent));
+            PM_i(indices) += detail::softplus(exponent);
 
             // Increment indices in row-major order
             bool done = true;
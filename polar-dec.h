@@ -3,7 +3,11 @@
 
 #include <vector>
 #include <limits>
+#include <span>
+#include <bit>
 
+#include "allocator.h"
+#include "minstar.h"
 #include "polar-enc.h"
 
 namespace eccpp {
@@ -12,10 +16,12 @@ namespace eccpp {
 template <typename T>
 class polar_dec {
 public:
-    polar_dec(size_t n, std::uint_fast32_t permutation_seed = 0) : n_(n), permutation_seed_(permutation_seed) {
-        if (!n || (n & (n - 1)) != 0)
-            throw std::invalid_argument("n must be a power of 2");
-    }
+    polar_dec(size_t n, std::uint_fast32_t permutation_seed = 0) : polar_dec(arikan_kernels(n), permutation_seed) {}
+
+    // codes built from any chain of kernels, must match the polar_enc_kernel used for encoding
+    polar_dec(std::vector<polar_kernel> kernels, std::uint_fast32_t permutation_seed = 0) : kernels_(std::move(kernels)),
+        n_(polar_length(kernels_)), permutation_seed_(permutation_seed),
+        perm_(permutation_seed ? shuffle_perm(n_, permutation_seed) : shuffle_perm()) {}
 
     struct result {
         std::vector<int> msg;
@@ -42,15 +48,15 @@ public:
         // unshuffle it. This is much more efficient than shuffling each codeword on the encoder side.
         std::vector<T> llr_unshuffled_storage;
         if (permutation_seed_) {
-            llr_unshuffled_storage = llr;
-            eccpp::unshuffle(llr_unshuffled_storage, permutation_seed_);
+            llr_unshuffled_storage.resize(n_);
+            perm_.unshuffle(llr, llr_unshuffled_storage);
         }
         auto& llr_unshuffled = permutation_seed_ ? llr_unshuffled_storage : llr;
 
         // encode all possible messages and pick the best match
         T best_match = std::numeric_limits<T>::lowest();
         T second_best_match = best_match;
-        polar_enc_butterfly enc(n_);
+        polar_enc_kernel enc(kernels_);
         std::vector<int> msg_with_frozen_bits(n_);
         while (true) {
             const auto codeword = enc.encode(msg_with_frozen_bits);
@@ -101,7 +107,7 @@ public:
         // encode all possible messages and pick the best match
         T best_match = std::numeric_limits<T>::lowest();
         T second_best_match = best_match;
-        polar_enc_butterfly enc(n_, permutation_seed_);
+        polar_enc_kernel enc(kernels_, permutation_seed_);
         std::vector<int> msg_with_frozen_bits(n_);
         const auto max_offset = n_ - llr.size();
         while (true) {
@@ -137,6 +143,13 @@ public:
 
 
 private:
+    static std::vector<polar_kernel> arikan_kernels(size_t n) {
+        if (!n || (n & (n - 1)) != 0)
+            throw std::invalid_argument("n must be a power of 2");
+
+        return std::vector<polar_kernel>(size_t(std::countr_zero(n)), polar_kernel::arikan());
+    }
+
     // increment message bits (f are frozen bits): ff0f0 -> ff0f1 -> ff1f0 -> ff1f1. Returns
     // false (no more messages) at 11..1 -> 00..0 roll-over.
     static bool next_message(std::vector<int>& msg_with_frozen_bits, const std::vector<size_t>& info_bits) {
@@ -159,8 +172,212 @@ private:
             msg[i] = msg_with_frozen_bits[info_bits[i]];
     }
 
+    const std::vector<polar_kernel> kernels_;
+    const size_t n_;
+    const std::uint_fast32_t permutation_seed_;
+    const shuffle_perm perm_;
+};
+
+
+// the order polar_dec_bp updates the stages of the factor graph in
+enum class polar_bp_schedule {
+    flooding,       // every stage at once, from the messages of the previous iteration
+    round_trip      // L messages swept from the codeword to u, then R messages back
+};
+
+//
+// belief propagation decoder on the factor graph of polar_enc_butterfly: columns of N nodes from
+// 0 (u, frozen bits included) to n = log2(N) (the codeword), with n stages of N/2 processing
+// elements in between. L messages go from the channel towards u, R messages from the frozen bits
+// (known to be 0, i.e. an infinite LLR) towards the channel. An element maps its inputs a, b to
+// c = a ^ b, d = b, so with f() the min-star (minstar.h):
+//   L(a) = f(L(c), L(d) + R(b))        R(c) = f(R(a), L(d) + R(b))
+//   L(b) = f(R(a), L(c)) + L(d)        R(d) = f(R(a), L(c)) + R(b)
+// The graph is laid out in constant geometry: every stage reads a, b from nodes p and p + N/2 of
+// its left column and has c, d at nodes 2p and 2p + 1 of the right one. That's the same transform
+// with the inner nodes renumbered, and every stage is the same handful of loops over N/2 with the
+// batched minstar(). Unlike polar_dec, the work per iteration doesn't depend on the number of info
+// bits. Decoding stops as soon as the hard decision on u re-encodes to the hard decision on the
+// codeword
+//
+template <typename T>
+class polar_dec_bp {
+public:
+    polar_dec_bp(size_t n, std::uint_fast32_t permutation_seed = 0, size_t max_iterations = 50,
+        polar_bp_schedule schedule = polar_bp_schedule::round_trip,
+        minstar_config<T> config = {minstar_mode::normalized_min_sum, T(0.5), T(0.9375)}) :
+        n_(n), stages_(log2_size(n)), max_iterations_(max_iterations), schedule_(schedule), config_(config),
+        permutation_seed_(permutation_seed), perm_(permutation_seed ? shuffle_perm(n, permutation_seed) : shuffle_perm()) {}
+
+    struct result {
+        std::vector<int> msg;
+        std::vector<int> codeword;  // the re-encoded hard decision, shuffled like polar_enc_butterfly's
+        size_t iterations = 0;
+        bool success = false;       // the hard decisions agreed, which doesn't mean they are right
+    };
+
+    // same llr and info_bits as polar_dec::decode()
+    result decode(const std::vector<T>& llr, const std::vector<size_t>& info_bits) const {
+        if (llr.size() != n_)
+            throw std::invalid_argument("LLR size must match transform size");
+
+        if (info_bits.empty())
+            throw std::invalid_argument("Info bits must not be empty");
+
+        if (info_bits.size() > n_)
+            throw std::invalid_argument("Info bits size greater than transform size");
+
+        const size_t N = n_;
+        const size_t S = stages_;
+
+        // column s of L / R is [s * N, (s + 1) * N)
+        buffer L((S + 1) * N, T(0));
+        buffer R((S + 1) * N, T(0));
+        buffer scratch(5 * (N / 2));
+        buffer saved(2 * N);
+
+        std::vector<T> channel = llr;
+        if (permutation_seed_)
+            perm_.unshuffle(llr, channel);
+        std::copy(channel.begin(), channel.end(), L.begin() + S * N);
+
+        std::fill(R.begin(), R.begin() + N, std::numeric_limits<T>::infinity());
+        for (auto i: info_bits) {
+            if (i >= N)
+                throw std::invalid_argument("Info bit index out of range");
+            R[i] = T(0);
+        }
+
+        std::vector<int> u(N), codeword(N);
+        result dec_result;
+        for (size_t iteration = 1; iteration <= max_iterations_; ++iteration) {
+            if (schedule_ == polar_bp_schedule::round_trip) {
+                for (size_t s = S; s-- > 0; )
+                    update_stage<true, false>(L.data() + (s + 1) * N, R.data() + s * N, L.data() + s * N, nullptr, scratch.data());
+                for (size_t s = 0; s < S; ++s)
+                    update_stage<false, true>(L.data() + (s + 1) * N, R.data() + s * N, nullptr, R.data() + (s + 1) * N, scratch.data());
+            }
+            else {
+                // going left to right, a stage's L input hasn't been touched yet and the L column
+                // it writes has been read already. Its R input has been overwritten by the stage
+                // before though, so the old R columns are kept aside, alternating between two copies
+                const T* r_in = R.data();
+                for (size_t s = 0; s < S; ++s) {
+                    T* r_out = R.data() + (s + 1) * N;
+                    T* keep = saved.data() + (s % 2) * N;
+                    std::copy(r_out, r_out + N, keep);
+                    update_stage<true, true>(L.data() + (s + 1) * N, r_in, L.data() + s * N, r_out, scratch.data());
+                    r_in = keep;
+                }
+            }
+
+            dec_result.iterations = iteration;
+            if (hard_decisions(L.data(), R.data(), u.data(), codeword.data())) {
+                dec_result.success = true;
+                break;
+            }
+        }
+
+        dec_result.msg.resize(info_bits.size());
+        for (size_t i = 0; i < info_bits.size(); ++i)
+            dec_result.msg[i] = u[info_bits[i]];
+
+        dec_result.codeword = std::move(codeword);
+        if (!perm_.empty())
+            perm_.shuffle(dec_result.codeword);
+
+        return dec_result;
+    }
+
+private:
+    using buffer = std::vector<T, aligned_allocator<T>>;
+
+    static size_t log2_size(size_t n) {
+        if (n < 2 || (n & (n - 1)) != 0)
+            throw std::invalid_argument("n must be a power of 2 (and at least 2)");
+
+        return size_t(std::countr_zero(n));
+    }
+
+    // one stage, l_in / r_out being the right column, r_in / l_out the left one. Left updates the
+    // L messages of the left column, Right the R messages of the right column
+    template <bool Left, bool Right>
+    void update_stage(const T* l_in, const T* r_in, T* l_out, T* r_out, T* scratch) const {
+        const size_t h = n_ / 2;
+        T* lc = scratch;
+        T* ld = scratch + h;
+        T* t = scratch + 2 * h;
+        T* ra_lc = scratch + 3 * h;
+        T* rc = scratch + 4 * h;
+        const T* ra = r_in;
+        const T* rb = r_in + h;
+        auto in = [h](const T* p) { return std::span<const T>(p, h); };
+        auto out = [h](T* p) { return std::span<T>(p, h); };
+
+        ECCPP_SIMD_LOOP
+        for (size_t p = 0; p < h; ++p) {
+            const T c = l_in[2 * p];
+            const T d = l_in[2 * p + 1];
+            lc[p] = c;
+            ld[p] = d;
+            t[p] = d + rb[p];
+        }
+        minstar<T>(in(ra), in(lc), out(ra_lc), config_);
+
+        if constexpr (Left) {
+            minstar<T>(in(lc), in(t), out(l_out), config_);
+            T* lb = l_out + h;
+            ECCPP_SIMD_LOOP
+            for (size_t p = 0; p < h; ++p)
+                lb[p] = ra_lc[p] + ld[p];
+        }
+
+        if constexpr (Right) {
+            minstar<T>(in(ra), in(t), out(rc), config_);
+            ECCPP_SIMD_LOOP
+            for (size_t p = 0; p < h; ++p) {
+                r_out[2 * p] = rc[p];
+                r_out[2 * p + 1] = ra_lc[p] + rb[p];
+            }
+        }
+    }
+
+    // u from column 0 (the frozen bits come out as 0) and its encoding into c. True if c agrees with
+    // the hard decision on the last column
+    bool hard_decisions(const T* L, const T* R, int* u, int* c) const {
+        const size_t N = n_;
+        ECCPP_SIMD_LOOP
+        for (size_t i = 0; i < N; ++i) {
+            u[i] = L[i] + R[i] < T(0);
+            c[i] = u[i];
+        }
+
+        // polar_enc_butterfly without the shuffle
+        for (size_t step = 1; step < N; step *= 2)
+            for (size_t i = 0; i < N; i += step * 2) {
+                int* e = c + i;
+                ECCPP_SIMD_LOOP
+                for (size_t j = 0; j < step; ++j)
+                    e[j] ^= e[j + step];
+            }
+
+        const T* l_last = L + stages_ * N;
+        const T* r_last = R + stages_ * N;
+        int mismatch = 0;
+        ECCPP_SIMD_LOOP
+        for (size_t i = 0; i < N; ++i)
+            mismatch |= c[i] ^ int(l_last[i] + r_last[i] < T(0));
+
+        return !mismatch;
+    }
+
     const size_t n_;
+    const size_t stages_;
+    const size_t max_iterations_;
+    const polar_bp_schedule schedule_;
+    const minstar_config<T> config_;
     const std::uint_fast32_t permutation_seed_;
+    const shuffle_perm perm_;
 };
 
 } // namespace eccpp
@@ -2,8 +2,14 @@
 #define ECCPP_POLAR_ENC_H
 
 #include <vector>
+#include <utility>
+#include <memory>
+#include <algorithm>
+#include <bit>
 
 #include "gn.h"
+#include "gn-cache.h"
+#include "polar-kernel.h"
 #include "shuffle.h"
 
 namespace eccpp {
@@ -14,34 +20,115 @@ public:
     // (or shuffle the bits of the codeword after encoding, which is equivalent).
     // permutation_seed = 0 means no shuffling, sometimes refered as "natural order".
     // If you come across "bit-reverse permutation matrix BN", it's the same thing.
-    polar_enc(size_t n, std::uint_fast32_t permutation_seed = 0) : gn_(gn(n)), permutation_seed_(permutation_seed) {}
+    polar_enc(size_t n, std::uint_fast32_t permutation_seed = 0) : gn_(n),
+        perm_(permutation_seed ? shuffle_perm(n, permutation_seed) : shuffle_perm()) {}
 
     std::vector<int> encode(const std::vector<int>& data) const {
         const auto N = data.size();
-        if (N != gn_.dimensions()[0])
+        if (N != gn_.size())
             throw std::invalid_argument("Data size must match generator matrix size");
 
         // this won't work as we need GF(2), not regular arithmetics
         //return data * gn_;
 
+        // only the rows with a 1 in column i contribute, which are the supersets of i
         std::vector<int> result(N);
         for (size_t i = 0; i < N; ++i) {
             int r = 0;
-            for (size_t j = 0; j < N; ++j)
-                r ^= data[j] & gn_({j, i});
+            gn_.for_each_in_column(i, [&](size_t j) { r ^= data[j] & 1; });
 
             result[i] = r;
         }
 
-        if (permutation_seed_)
-            eccpp::shuffle(result, permutation_seed_);
+        if (!perm_.empty())
+            perm_.shuffle(result);
 
         return result;
     }
 
 private:
-    const mdarray<int> gn_;
-    const std::uint_fast32_t permutation_seed_;
+    const gn_view gn_;
+    const shuffle_perm perm_;
+};
+
+//
+// same thing as polar_enc, but G_n (or any other square generator matrix) is kept as a packed
+// gf2_matrix, so encoding is XORing the rows selected by the data bits, 64 bits at a time.
+// G_n comes from the process-wide cache, so encoders of the same size share it
+//
+class polar_enc_gf2 {
+public:
+    polar_enc_gf2(size_t n, std::uint_fast32_t permutation_seed = 0) : polar_enc_gf2(gn_gf2_cached(n), permutation_seed) {}
+
+    polar_enc_gf2(gf2_matrix generator, std::uint_fast32_t permutation_seed = 0) :
+        polar_enc_gf2(std::make_shared<const gf2_matrix>(std::move(generator)), permutation_seed) {}
+
+    polar_enc_gf2(std::shared_ptr<const gf2_matrix> generator, std::uint_fast32_t permutation_seed = 0) : gn_(std::move(generator)),
+        perm_(permutation_seed ? shuffle_perm(gn_->rows(), permutation_seed) : shuffle_perm()) {
+        if (gn_->rows() != gn_->cols())
+            throw std::invalid_argument("Generator matrix must be square");
+    }
+
+    const gf2_matrix& generator() const { return *gn_; }
+
+    std::vector<int> encode(const std::vector<int>& data) const {
+        if (data.size() != gn_->rows())
+            throw std::invalid_argument("Data size must match generator matrix size");
+
+        auto result = unpack_bits(pack_bits(data) * *gn_, data.size());
+
+        if (!perm_.empty())
+            perm_.shuffle(result);
+
+        return result;
+    }
+
+private:
+    const std::shared_ptr<const gf2_matrix> gn_;
+    const shuffle_perm perm_;
+};
+
+//
+// same thing as polar_enc, but G_n (or any other square generator matrix) is kept in sparse CSC
+// form, so every codeword bit is a parity over the nonzeros of its column only. The columns can
+// be split across threads with an execution policy. G_n is shared through the process-wide cache
+//
+class polar_enc_sparse {
+public:
+    polar_enc_sparse(size_t n, std::uint_fast32_t permutation_seed = 0) : polar_enc_sparse(gn_csc_cached(n), permutation_seed) {}
+
+    polar_enc_sparse(csc_matrix<int> generator, std::uint_fast32_t permutation_seed = 0) :
+        polar_enc_sparse(std::make_shared<const csc_matrix<int>>(std::move(generator)), permutation_seed) {}
+
+    polar_enc_sparse(std::shared_ptr<const csc_matrix<int>> generator, std::uint_fast32_t permutation_seed = 0) : gn_(std::move(generator)),
+        perm_(permutation_seed ? shuffle_perm(gn_->rows(), permutation_seed) : shuffle_perm()) {
+        if (gn_->rows() != gn_->cols())
+            throw std::invalid_argument("Generator matrix must be square");
+    }
+
+    const csc_matrix<int>& generator() const { return *gn_; }
+
+    std::vector<int> encode(const std::vector<int>& data) const {
+        return encode(execution::seq, data);
+    }
+
+    template <execution_policy P>
+    std::vector<int> encode(P policy, const std::vector<int>& data) const {
+        if (data.size() != gn_->rows())
+            throw std::invalid_argument("Data size must match generator matrix size");
+
+        // data * G_n = G_n^T * data
+        auto result = unpack_bits(gn_->gf2_transpose_multiply(policy, pack_bits(data)), data.size());
+
+        if (!perm_.empty())
+            perm_.shuffle(result);
+
+        return result;
+    }
+
+private:
+    const std::shared_ptr<const csc_matrix<int>> gn_;
+    const shuffle_perm perm_;
 };
 
 //
@@ -50,7 +137,8 @@ private:
 //
 class polar_enc_butterfly {
 public:
-    polar_enc_butterfly(size_t n, std::uint_fast32_t permutation_seed = 0) : N(n), permutation_seed_(permutation_seed) {
+    polar_enc_butterfly(size_t n, std::uint_fast32_t permutation_seed = 0) : N(n),
+        perm_(permutation_seed ? shuffle_perm(n, permutation_seed) : shuffle_perm()) {
         if (!n || (n & (n - 1)) != 0)
             throw std::invalid_argument("n must be a power of 2");
     }
@@ -65,15 +153,88 @@ public:
                 for (size_t j = 0; j < step; ++j)
                     result[i + j] ^= result[i + j + step];
 
-        if (permutation_seed_)
-            eccpp::shuffle(result, permutation_seed_);
+        if (!perm_.empty())
+            perm_.shuffle(result);
+
+        return result;
+    }
+
+private:
+    const size_t N;
+    const shuffle_perm perm_;
+};
+
+//
+// polar_enc_butterfly for any chain of kernels (see polar-kernel.h), N = q_1 * ... * q_m.
+// The codeword is data * (K_1 (x) ... (x) K_m): data is viewed as a q_1 x ... x q_m tensor and
+// every kernel is applied along its own axis, O(N * sum of q_k) XORs in total. Lower unit
+// triangular kernels (Arikan's included) are applied in place, so with 2x2 kernels this is the
+// same radix-2 butterfly as polar_enc_butterfly.
+//
+class polar_enc_kernel {
+public:
+    polar_enc_kernel(std::vector<polar_kernel> kernels, std::uint_fast32_t permutation_seed = 0) :
+        kernels_(std::move(kernels)), N(polar_length(kernels_)),
+        perm_(permutation_seed ? shuffle_perm(N, permutation_seed) : shuffle_perm()) {}
+
+    // N = 2^a * 3^b, see polar_kernels()
+    polar_enc_kernel(size_t n, std::uint_fast32_t permutation_seed = 0) : polar_enc_kernel(polar_kernels(n), permutation_seed) {}
+
+    size_t size() const { return N; }
+    const std::vector<polar_kernel>& kernels() const { return kernels_; }
+
+    std::vector<int> encode(const std::vector<int>& data) const {
+        if (N != data.size())
+            throw std::invalid_argument("Data size must match transform size");
+
+        auto result = data;
+        std::vector<int> tmp;
+
+        // kernel k works on groups of q_k elements, stride apart
+        size_t stride = N;
+        for (const auto& kernel: kernels_) {
+            const size_t q = kernel.size();
+            stride /= q;
+
+            for (size_t base = 0; base < N; base += q * stride) {
+                int* x = result.data() + base;
+
+                if (kernel.lower_unit_triangular()) {
+                    for (size_t c = 0; c < q; ++c) {
+                        auto rows = kernel.column_mask(c) & ~(std::uint64_t(1) << c);
+                        for (; rows; rows &= rows - 1) {
+                            const int* src = x + size_t(std::countr_zero(rows)) * stride;
+                            int* dst = x + c * stride;
+                            for (size_t j = 0; j < stride; ++j)
+                                dst[j] ^= src[j];
+                        }
+                    }
+                    continue;
+                }
+
+                tmp.assign(x, x + q * stride);
+                for (size_t c = 0; c < q; ++c) {
+                    int* dst = x + c * stride;
+                    std::fill(dst, dst + stride, 0);
+                    for (auto rows = kernel.column_mask(c); rows; rows &= rows - 1) {
+                        const int* src = tmp.data() + size_t(std::countr_zero(rows)) * stride;
+                        for (size_t j = 0; j < stride; ++j)
+                            dst[j] ^= src[j];
+                    }
+                }
+            }
+        }
+
+        if (!perm_.empty())
+            perm_.shuffle(result);
 
         return result;
     }
 
 private:
+    const std::vector<polar_kernel> kernels_;
     const size_t N;
-    const std::uint_fast32_t permutation_seed_;
+    const shuffle_perm perm_;
 };
 
 } // namespace eccpp
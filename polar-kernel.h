@@ -0,0 +1,133 @@
+// polarizing kernels other than Arikan's [[1,0],[1,1]]. A polar code of length N = q_1 * ... * q_m
+// uses the generator K_1 (x) K_2 (x) ... (x) K_m, so mixing 2x2 and 3x3 kernels gives lengths
+// like 2^a * 3^b instead of powers of 2 only (multi-kernel polar codes). With m Arikan kernels
+// the generator is exactly gn(2^m).
+
+#ifndef ECCPP_POLAR_KERNEL_H
+#define ECCPP_POLAR_KERNEL_H
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include "kron.h"
+#include "gf2-matrix.h"
+
+namespace eccpp {
+
+//
+// a square binary kernel, it has to be invertible over GF(2) so encoding is a bijection
+//
+class polar_kernel {
+public:
+    explicit polar_kernel(mdarray<int> matrix): matrix_(std::move(matrix)) {
+        const auto& dims = matrix_.dimensions();
+        if (dims.size() != 2 || dims[0] != dims[1])
+            throw std::invalid_argument("Kernel must be a square matrix");
+
+        if (dims[0] > 64)
+            throw std::invalid_argument("Kernel size must not exceed 64");
+
+        for (size_t i = 0; i < matrix_.size(); ++i)
+            if (matrix_.data()[i] != 0 && matrix_.data()[i] != 1)
+                throw std::invalid_argument("Kernel must be binary");
+
+        if (gf2_matrix(matrix_).rank() != dims[0])
+            throw std::invalid_argument("Kernel must be invertible over GF(2)");
+
+        // row i of the input contributes to output c if K[i][c] is set
+        const size_t q = dims[0];
+        columns_.resize(q);
+        lower_unit_ = true;
+        for (size_t c = 0; c < q; ++c) {
+            for (size_t i = 0; i < q; ++i)
+                if (matrix_.data()[i * q + c])
+                    columns_[c] |= std::uint64_t(1) << i;
+
+            if ((columns_[c] & ((std::uint64_t(2) << c) - 1)) != (std::uint64_t(1) << c))
+                lower_unit_ = false;
+        }
+    }
+
+    // [[1,0],[1,1]]
+    static polar_kernel arikan() {
+        return polar_kernel(mdarray<int>({2, 2}, std::vector<int>{1, 0, 1, 1}));
+    }
+
+    // [[1,1,1],[1,0,1],[0,1,1]], the 3x3 kernel with the best error exponent
+    static polar_kernel ternary() {
+        return polar_kernel(mdarray<int>({3, 3}, std::vector<int>{1, 1, 1, 1, 0, 1, 0, 1, 1}));
+    }
+
+    size_t size() const { return columns_.size(); }
+    const mdarray<int>& matrix() const { return matrix_; }
+
+    int operator()(size_t r, size_t c) const {
+        if (r >= size() || c >= size())
+            throw std::invalid_argument("Index out of bounds");
+
+        return matrix_.data()[r * size() + c];
+    }
+
+    // bit i is set if K[i][c] is 1
+    std::uint64_t column_mask(size_t c) const { return columns_[c]; }
+
+    // ones on the diagonal, zeros above it: output c only needs inputs c and later, so the
+    // transform can run in place going from the first column to the last
+    bool lower_unit_triangular() const { return lower_unit_; }
+
+private:
+    mdarray<int> matrix_;
+    std::vector<std::uint64_t> columns_;
+    bool lower_unit_;
+};
+
+// codeword length for a chain of kernels, the empty chain is length 1
+inline size_t polar_length(const std::vector<polar_kernel>& kernels) {
+    size_t n = 1;
+    for (const auto& k: kernels)
+        n = detail::kron_checked_product(n, k.size());
+
+    return n;
+}
+
+// kernels for N = 2^a * 3^b: a Arikan kernels followed by b ternary ones
+inline std::vector<polar_kernel> polar_kernels(size_t n) {
+    if (!n)
+        throw std::invalid_argument("n must be of the form 2^a * 3^b");
+
+    size_t twos = 0;
+    size_t threes = 0;
+    for (; n % 2 == 0; n /= 2)
+        ++twos;
+    for (; n % 3 == 0; n /= 3)
+        ++threes;
+
+    if (n != 1)
+        throw std::invalid_argument("n must be of the form 2^a * 3^b");
+
+    std::vector<polar_kernel> result(twos, polar_kernel::arikan());
+    result.insert(result.end(), threes, polar_kernel::ternary());
+    return result;
+}
+
+// K_1 (x) ... (x) K_m as a lazy view, products with it cost O(N * sum of q_k)
+inline kron_view<int> kernel_gn_kron_view(const std::vector<polar_kernel>& kernels) {
+    if (kernels.empty())
+        return kron_view<int>({mdarray<int>({1, 1}, std::vector<int>{1})});
+
+    std::vector<mdarray<int>> factors;
+    for (const auto& k: kernels)
+        factors.push_back(k.matrix());
+
+    return kron_view<int>(std::move(factors));
+}
+
+// dense N x N generator
+inline mdarray<int> kernel_gn(const std::vector<polar_kernel>& kernels) {
+    return kernel_gn_kron_view(kernels).to_mdarray();
+}
+
+} // namespace eccpp
+
+#endif // ECCPP_POLAR_KERNEL_H
@@ -0,0 +1,405 @@
+// compressed sparse matrices: CSR (row_major, the nonzeros of every row stored together) and
+// CSC (column_major, the same per column). Both support real and GF(2) matrix-vector products
+// in either direction, A * x and A^T * x:
+// * along the compressed dimension (A * x for CSR, A^T * x for CSC) every output element is a
+//   gather over a single row/column, those products take an execution policy and split the
+//   rows/columns across threads, in ranges with about the same number of nonzeros;
+// * the other direction scatters into the output and always runs sequentially, so convert
+//   (to_csr()/to_csc()) when it's the hot one.
+// GF(2) products treat every stored nonzero as 1 and work on packed bit vectors (bitpack.h).
+
+#ifndef ECCPP_SPARSE_H
+#define ECCPP_SPARSE_H
+
+#include <vector>
+#include <span>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+
+#include "bitpack.h"
+#include "execution.h"
+#include "gf2-matrix.h"
+#include "mdarray.h"
+
+namespace eccpp {
+
+namespace detail {
+
+// calls fn(begin, end) over the major lines [0, offsets.size() - 1) of a compressed matrix, split
+// into ranges with about the same number of nonzeros and a thread per min_nonzeros of them at
+// most. Range boundaries are multiples of align lines
+template <execution_policy P, typename Fn>
+void for_each_sparse_range(P policy, std::span<const size_t> offsets, size_t align, Fn fn,
+    size_t min_nonzeros = min_parallel_elements) {
+    const size_t lines = offsets.size() - 1;
+    const size_t nonzeros = offsets.back();
+
+    // the line nonzero k belongs to, or the one after if k is the first of its line
+    auto line = [&](size_t k) {
+        if (!k)
+            return size_t(0);
+        if (k == nonzeros)
+            return lines;
+
+        const auto i = size_t(std::lower_bound(offsets.begin(), offsets.end(), k) - offsets.begin());
+        return i / align * align;
+    };
+
+    for_each_range(policy, nonzeros, 1, min_nonzeros, [&](size_t begin, size_t end) {
+        const size_t first = line(begin);
+        const size_t last = line(end);
+        if (first < last)
+            fn(first, last);
+    });
+}
+
+} // namespace detail
+
+enum class sparse_layout {
+    row_major,      // CSR
+    column_major    // CSC
+};
+
+template <typename T, sparse_layout Layout>
+class sparse_matrix {
+public:
+    using value_type = T;
+    using index_type = std::uint32_t;
+
+    static constexpr sparse_layout layout = Layout;
+
+    // raw compressed arrays: the nonzeros of row (CSR) or column (CSC) i are
+    // indices/values[offsets[i], offsets[i + 1]), with strictly increasing indices
+    sparse_matrix(size_t rows, size_t cols, std::vector<size_t> offsets, std::vector<index_type> indices, std::vector<T> values):
+        rows_(rows), cols_(cols), offsets_(std::move(offsets)), indices_(std::move(indices)), values_(std::move(values)) {
+        check_dimensions();
+        if (offsets_.size() != major_size() + 1 || offsets_.front() != 0 || offsets_.back() != indices_.size() || indices_.size() != values_.size())
+            throw std::invalid_argument("Inconsistent sparse matrix arrays");
+
+        for (size_t i = 0; i < major_size(); ++i) {
+            if (offsets_[i] > offsets_[i + 1])
+                throw std::invalid_argument("Inconsistent sparse matrix arrays");
+
+            for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k)
+                if (indices_[k] >= minor_size() || (k > offsets_[i] && indices_[k] <= indices_[k - 1]))
+                    throw std::invalid_argument("Sparse matrix indices must be increasing and in bounds");
+        }
+    }
+
+    // keeps the non-zero elements of a 2D mdarray
+    template <typename A>
+    explicit sparse_matrix(const mdarray<T, A>& dense) {
+        const auto& dims = dense.dimensions();
+        if (dims.size() != 2)
+            throw std::invalid_argument("Sparse matrix requires a 2D mdarray");
+
+        rows_ = dims[0];
+        cols_ = dims[1];
+        check_dimensions();
+
+        const T* data = dense.data();
+        offsets_.reserve(major_size() + 1);
+        offsets_.push_back(0);
+        for (size_t i = 0; i < major_size(); ++i) {
+            for (size_t j = 0; j < minor_size(); ++j) {
+                const T v = Layout == sparse_layout::row_major ? data[i * cols_ + j] : data[j * cols_ + i];
+                if (v != T()) {
+                    indices_.push_back(index_type(j));
+                    values_.push_back(v);
+                }
+            }
+            offsets_.push_back(indices_.size());
+        }
+    }
+
+    // set bits become T(1)
+    explicit sparse_matrix(const gf2_matrix& m): rows_(m.rows()), cols_(m.cols()) {
+        check_dimensions();
+
+        offsets_.reserve(major_size() + 1);
+        offsets_.push_back(0);
+        for (size_t i = 0; i < major_size(); ++i) {
+            if constexpr (Layout == sparse_layout::row_major) {
+                const auto* row = m.row(i);
+                for (size_t w = 0; w < m.words_per_row(); ++w)
+                    for (auto bits = row[w]; bits; bits &= bits - 1)
+                        indices_.push_back(index_type(w * 64 + std::countr_zero(bits)));
+            }
+            else {
+                for (size_t r = 0; r < rows_; ++r)
+                    if ((m.row(r)[i / 64] >> (i % 64)) & 1)
+                        indices_.push_back(index_type(r));
+            }
+            offsets_.push_back(indices_.size());
+        }
+        values_.assign(indices_.size(), T(1));
+    }
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    size_t nonzeros() const { return indices_.size(); }
+
+    // positions and values of the nonzeros of row (CSR) or column (CSC) i
+    std::span<const index_type> indices(size_t i) const {
+        check_major(i);
+        return std::span<const index_type>(indices_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+
+    std::span<const T> values(size_t i) const {
+        check_major(i);
+        return std::span<const T>(values_.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+    }
+
+    // calls fn(column, value) for every nonzero of row r, in ascending column order
+    template <typename Fn> requires (Layout == sparse_layout::row_major)
+    void for_each_in_row(size_t r, Fn&& fn) const {
+        for_each_nonzero(r, fn);
+    }
+
+    // calls fn(row, value) for every nonzero of column c, in ascending row order
+    template <typename Fn> requires (Layout == sparse_layout::column_major)
+    void for_each_in_column(size_t c, Fn&& fn) const {
+        for_each_nonzero(c, fn);
+    }
+
+    T operator()(size_t r, size_t c) const {
+        if (r >= rows_ || c >= cols_)
+            throw std::invalid_argument("Index out of bounds");
+
+        const size_t i = Layout == sparse_layout::row_major ? r : c;
+        const size_t j = Layout == sparse_layout::row_major ? c : r;
+        const auto begin = indices_.begin() + offsets_[i];
+        const auto end = indices_.begin() + offsets_[i + 1];
+        const auto it = std::lower_bound(begin, end, index_type(j));
+        return (it != end && *it == j) ? values_[it - indices_.begin()] : T();
+    }
+
+    mdarray<T> to_mdarray() const {
+        mdarray<T> result({rows_, cols_});
+        T* data = result.data();
+        for (size_t i = 0; i < major_size(); ++i)
+            for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k)
+                data[Layout == sparse_layout::row_major ? i * cols_ + indices_[k] : indices_[k] * cols_ + i] = values_[k];
+
+        return result;
+    }
+
+    // the same matrix in the other layout (a counting sort of the nonzeros)
+    sparse_matrix<T, sparse_layout::row_major> to_csr() const { return to_layout<sparse_layout::row_major>(); }
+    sparse_matrix<T, sparse_layout::column_major> to_csc() const { return to_layout<sparse_layout::column_major>(); }
+
+    // A * x
+    std::vector<T> multiply(const std::vector<T>& x) const { return multiply(execution::seq, x); }
+
+    template <execution_policy P>
+    std::vector<T> multiply(P policy, const std::vector<T>& x) const {
+        if (x.size() != cols_)
+            throw std::invalid_argument("Dimension mismatch for matrix-vector product");
+
+        if constexpr (Layout == sparse_layout::row_major)
+            return gather(policy, x);
+        else
+            return scatter(x);
+    }
+
+    std::vector<T> operator*(const std::vector<T>& x) const { return multiply(x); }
+
+    // A^T * x, i.e. x as a row vector times A
+    std::vector<T> transpose_multiply(const std::vector<T>& x) const { return transpose_multiply(execution::seq, x); }
+
+    template <execution_policy P>
+    std::vector<T> transpose_multiply(P policy, const std::vector<T>& x) const {
+        if (x.size() != rows_)
+            throw std::invalid_argument("Dimension mismatch for vector-matrix product");
+
+        if constexpr (Layout == sparse_layout::column_major)
+            return gather(policy, x);
+        else
+            return scatter(x);
+    }
+
+    // A * x over GF(2), x is a packed vector of cols() bits, the result has rows() bits
+    std::vector<std::uint64_t> gf2_multiply(const std::vector<std::uint64_t>& x) const { return gf2_multiply(execution::seq, x); }
+
+    template <execution_policy P>
+    std::vector<std::uint64_t> gf2_multiply(P policy, const std::vector<std::uint64_t>& x) const {
+        if (x.size() != packed_words(cols_))
+            throw std::invalid_argument("Dimension mismatch for matrix-vector product");
+
+        if constexpr (Layout == sparse_layout::row_major)
+            return gf2_gather(policy, x);
+        else
+            return gf2_scatter(x);
+    }
+
+    // A^T * x over GF(2), x is a packed vector of rows() bits, the result has cols() bits
+    std::vector<std::uint64_t> gf2_transpose_multiply(const std::vector<std::uint64_t>& x) const {
+        return gf2_transpose_multiply(execution::seq, x);
+    }
+
+    template <execution_policy P>
+    std::vector<std::uint64_t> gf2_transpose_multiply(P policy, const std::vector<std::uint64_t>& x) const {
+        if (x.size() != packed_words(rows_))
+            throw std::invalid_argument("Dimension mismatch for vector-matrix product");
+
+        if constexpr (Layout == sparse_layout::column_major)
+            return gf2_gather(policy, x);
+        else
+            return gf2_scatter(x);
+    }
+
+    friend bool operator==(const sparse_matrix& lhs, const sparse_matrix& rhs) {
+        return lhs.rows_ == rhs.rows_ && lhs.cols_ == rhs.cols_ && lhs.offsets_ == rhs.offsets_ &&
+               lhs.indices_ == rhs.indices_ && lhs.values_ == rhs.values_;
+    }
+    friend bool operator!=(const sparse_matrix& lhs, const sparse_matrix& rhs) {
+        return !(lhs == rhs);
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const sparse_matrix& m) {
+        for (size_t i = 0; i < m.major_size(); ++i)
+            for (size_t k = m.offsets_[i]; k < m.offsets_[i + 1]; ++k)
+                os << "(" << (Layout == sparse_layout::row_major ? i : m.indices_[k]) << ", " <<
+                    (Layout == sparse_layout::row_major ? m.indices_[k] : i) << ") " << m.values_[k] << "\n";
+
+        return os;
+    }
+
+private:
+    template <typename, sparse_layout>
+    friend class sparse_matrix;
+
+    sparse_matrix() = default;
+
+    size_t major_size() const { return Layout == sparse_layout::row_major ? rows_ : cols_; }
+    size_t minor_size() const { return Layout == sparse_layout::row_major ? cols_ : rows_; }
+
+    void check_dimensions() const {
+        if (!rows_ || !cols_)
+            throw std::invalid_argument("Invalid zero-size dimension");
+        if (minor_size() > size_t(std::numeric_limits<index_type>::max()))
+            throw std::invalid_argument("Dimensions too large");
+    }
+
+    void check_major(size_t i) const {
+        if (i >= major_size())
+            throw std::invalid_argument("Index out of bounds");
+    }
+
+    template <typename Fn>
+    void for_each_nonzero(size_t i, Fn& fn) const {
+        check_major(i);
+        for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k)
+            fn(size_t(indices_[k]), values_[k]);
+    }
+
+    template <sparse_layout L>
+    sparse_matrix<T, L> to_layout() const {
+        if constexpr (L == Layout)
+            return *this;
+        else {
+            sparse_matrix<T, L> result;
+            result.rows_ = rows_;
+            result.cols_ = cols_;
+            result.offsets_.assign(minor_size() + 1, 0);
+            for (auto j: indices_)
+                ++result.offsets_[j + 1];
+            for (size_t j = 0; j < minor_size(); ++j)
+                result.offsets_[j + 1] += result.offsets_[j];
+
+            result.indices_.resize(indices_.size());
+            result.values_.resize(values_.size());
+            auto next = result.offsets_;
+            for (size_t i = 0; i < major_size(); ++i) {
+                for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k) {
+                    const size_t dst = next[indices_[k]]++;
+                    result.indices_[dst] = index_type(i);
+                    result.values_[dst] = values_[k];
+                }
+            }
+            return result;
+        }
+    }
+
+    // y[i] = sum over the nonzeros of major line i, every thread owns a contiguous range of y
+    template <execution_policy P>
+    std::vector<T> gather(P policy, const std::vector<T>& x) const {
+        std::vector<T> y(major_size());
+        detail::for_each_sparse_range(policy, offsets_, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                T acc = T();
+                for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k)
+                    acc += values_[k] * x[indices_[k]];
+
+                y[i] = acc;
+            }
+        });
+        return y;
+    }
+
+    std::vector<T> scatter(const std::vector<T>& x) const {
+        std::vector<T> y(minor_size());
+        for (size_t i = 0; i < major_size(); ++i) {
+            const T xi = x[i];
+            for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k)
+                y[indices_[k]] += values_[k] * xi;
+        }
+        return y;
+    }
+
+    // ranges start at multiples of 64 lines, so threads never share an output word
+    template <execution_policy P>
+    std::vector<std::uint64_t> gf2_gather(P policy, const std::vector<std::uint64_t>& x) const {
+        if (x.size() != packed_words(minor_size()))
+            throw std::invalid_argument("Dimension mismatch for sparse GF(2) product");
+
+        std::vector<std::uint64_t> y(packed_words(major_size()));
+        detail::for_each_sparse_range(policy, offsets_, 64, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                std::uint64_t acc = 0;
+                for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k)
+                    acc ^= x[indices_[k] / 64] >> (indices_[k] % 64);
+
+                y[i / 64] |= (acc & 1) << (i % 64);
+            }
+        });
+        return y;
+    }
+
+    // bits of x past major_size() are ignored
+    std::vector<std::uint64_t> gf2_scatter(const std::vector<std::uint64_t>& x) const {
+        if (x.size() != packed_words(major_size()))
+            throw std::invalid_argument("Dimension mismatch for sparse GF(2) product");
+
+        std::vector<std::uint64_t> y(packed_words(minor_size()));
+        for (size_t w = 0; w < x.size(); ++w) {
+            const auto used = w + 1 == x.size() ? packed_tail_mask(major_size()) : ~std::uint64_t(0);
+            for (auto bits = x[w] & used; bits; bits &= bits - 1) {
+                const size_t i = w * 64 + std::countr_zero(bits);
+                for (size_t k = offsets_[i]; k < offsets_[i + 1]; ++k)
+                    y[indices_[k] / 64] ^= std::uint64_t(1) << (indices_[k] % 64);
+            }
+        }
+        return y;
+    }
+
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    std::vector<size_t> offsets_;
+    std::vector<index_type> indices_;
+    std::vector<T> values_;
+};
+
+template <typename T>
+using csr_matrix = sparse_matrix<T, sparse_layout::row_major>;
+
+template <typename T>
+using csc_matrix = sparse_matrix<T, sparse_layout::column_major>;
+
+} // namespace eccpp
+
+#endif // ECCPP_SPARSE_H
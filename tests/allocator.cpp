@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "allocator.h"
+#include "kron.h"
+#include "mdarray.h"
+#include "phi.h"
+
+template <typename T>
+static bool is_aligned(const T* p, size_t alignment = 64) {
+    return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+TEST(AllocatorTest, DefaultIsAligned) {
+    for (size_t n: {1, 3, 17, 1000}) {
+        eccpp::mdarray<char> a({n});
+        eccpp::mdarray<double> b({n, 3});
+        EXPECT_TRUE(is_aligned(a.data()));
+        EXPECT_TRUE(is_aligned(b.data()));
+    }
+}
+
+TEST(AllocatorTest, ArenaBumpAndReset) {
+    eccpp::monotonic_arena arena(4096);
+    EXPECT_EQ(arena.used(), 0);
+
+    auto* p1 = static_cast<char*>(arena.allocate(10));
+    auto* p2 = static_cast<char*>(arena.allocate(10));
+    EXPECT_TRUE(is_aligned(p1));
+    EXPECT_TRUE(is_aligned(p2));
+    EXPECT_EQ(p2 - p1, 64);
+    EXPECT_EQ(arena.used(), 74);
+
+    // spills into a second block, merged into a single one on reset
+    arena.allocate(8000);
+    EXPECT_GT(arena.capacity(), 4096);
+    const size_t capacity = arena.capacity();
+
+    arena.reset();
+    EXPECT_EQ(arena.used(), 0);
+    EXPECT_EQ(arena.capacity(), capacity);
+
+    auto* q1 = static_cast<char*>(arena.allocate(10));
+    arena.allocate(8000);
+    EXPECT_EQ(arena.capacity(), capacity);
+    arena.reset();
+    EXPECT_EQ(static_cast<char*>(arena.allocate(10)), q1);
+}
+
+TEST(AllocatorTest, ArenaMdarray) {
+    using arena_array = eccpp::mdarray<double, eccpp::arena_allocator<double>>;
+
+    eccpp::monotonic_arena arena;
+    const double* first = nullptr;
+
+    for (int frame = 0; frame < 3; ++frame) {
+        eccpp::arena_scope scope(arena);
+
+        arena_array a({2, 2});
+        arena_array b({2, 2});
+        EXPECT_EQ(a.get_allocator().arena(), &arena);
+        if (!frame)
+            first = a.data();
+        else
+            EXPECT_EQ(a.data(), first);     // same memory every frame
+
+        a({0, 0}) = 1; a({0, 1}) = 2; a({1, 0}) = 3; a({1, 1}) = 4;
+        b({0, 0}) = 1; b({1, 1}) = 1;
+
+        arena_array c = a + b * 2.0;
+        EXPECT_EQ(c({0, 0}), 3);
+        EXPECT_EQ(c({1, 1}), 6);
+        EXPECT_EQ(c.get_allocator().arena(), &arena);
+
+        arena_array d = a * b;
+        EXPECT_EQ(d, a);
+
+        const auto k = eccpp::kron(a, b);
+        EXPECT_EQ(k.dimensions(), (std::vector<size_t>{4, 4}));
+        EXPECT_EQ(k({3, 3}), 4);
+        EXPECT_EQ(k.get_allocator().arena(), &arena);
+
+        const auto pm = eccpp::phi(a, b, 0.0, true);
+        static_assert(std::is_same_v<std::decay_t<decltype(pm)>, arena_array>);
+        EXPECT_EQ(pm.get_allocator().arena(), &arena);
+
+        arena.reset();
+    }
+
+    // no arena, falls back to the heap
+    arena_array heap({4});
+    EXPECT_EQ(heap.get_allocator().arena(), nullptr);
+    EXPECT_TRUE(is_aligned(heap.data()));
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <algorithm>
+
+#include "code-analysis.h"
+#include "polar-enc.h"
+#include "hamweight.h"
+
+namespace {
+
+std::vector<std::uint64_t> binomials(size_t n) {
+    std::vector<std::uint64_t> result(n + 1, 1);
+    for (size_t w = 1; w < n; ++w)
+        result[w] = result[w - 1] * (n - w + 1) / w;
+    return result;
+}
+
+}
+
+TEST(CodeAnalysisTest, ReedMuller) {
+    // the rows of G_8 with weight 4 or more are RM(1, 3), the [8, 4, 4] extended Hamming code
+    auto spectrum = eccpp::weight_enumerator(eccpp::polar_generator(8, {3, 5, 6, 7}));
+    EXPECT_EQ(spectrum.weights, (std::vector<std::uint64_t>{1, 0, 0, 0, 14, 0, 0, 0, 1}));
+    EXPECT_EQ(spectrum.min_distance, 4u);
+    EXPECT_EQ(spectrum.multiplicity, 14u);
+
+    // RM(1, 4): 30 codewords of weight 8, the same with the columns shuffled
+    spectrum = eccpp::weight_enumerator(eccpp::execution::par, eccpp::polar_generator(16, {7, 11, 13, 14, 15}, 77));
+    std::vector<std::uint64_t> expected(17);
+    expected[0] = 1;
+    expected[8] = 30;
+    expected[16] = 1;
+    EXPECT_EQ(spectrum.weights, expected);
+    EXPECT_EQ(spectrum.min_distance, 8u);
+    EXPECT_EQ(spectrum.multiplicity, 30u);
+
+    // every row: the whole space
+    std::vector<size_t> all(16);
+    for (size_t i = 0; i < 16; ++i)
+        all[i] = i;
+    spectrum = eccpp::weight_enumerator(eccpp::polar_generator(16, all));
+    EXPECT_EQ(spectrum.weights, binomials(16));
+    EXPECT_EQ(spectrum.min_distance, 1u);
+    EXPECT_EQ(spectrum.multiplicity, 16u);
+}
+
+TEST(CodeAnalysisTest, MatchesEncoder) {
+    const size_t n = 128;
+    const std::uint_fast32_t seed = 5;
+    const std::vector<size_t> info_bits = {31, 47, 55, 59, 61, 62, 63, 79, 87, 91, 93, 94, 95, 103, 107, 127};
+    eccpp::polar_enc_butterfly enc(n, seed);
+    const auto generator = eccpp::polar_generator(n, info_bits, seed);
+
+    // every message through the encoder
+    std::vector<std::uint64_t> expected(n + 1);
+    std::vector<int> msg(n);
+    for (std::uint64_t m = 0; m < (std::uint64_t(1) << info_bits.size()); ++m) {
+        for (size_t i = 0; i < info_bits.size(); ++i)
+            msg[info_bits[i]] = int((m >> i) & 1);
+        const auto codeword = enc.encode(msg);
+        ++expected[eccpp::hamweight(codeword)];
+
+        // message bit i picks generator row i
+        if (m % 1000 == 1) {
+            EXPECT_EQ(std::vector<std::uint64_t>{m} * generator, eccpp::pack_bits(codeword));
+        }
+    }
+
+    const auto seq = eccpp::weight_enumerator(eccpp::execution::seq, generator);
+    EXPECT_EQ(seq.weights, expected);
+    for (size_t threads: {2, 3, 7}) {
+        const auto par = eccpp::weight_enumerator(eccpp::execution::par(threads), generator);
+        EXPECT_EQ(par.weights, expected);
+        EXPECT_EQ(par.min_distance, seq.min_distance);
+        EXPECT_EQ(par.multiplicity, seq.multiplicity);
+    }
+}
+
+TEST(CodeAnalysisTest, ThrowOnBadInput) {
+    EXPECT_THROW(eccpp::polar_generator(12, {1}), std::invalid_argument);
+    EXPECT_THROW(eccpp::polar_generator(16, {}), std::invalid_argument);
+    EXPECT_THROW(eccpp::polar_generator(16, {3, 16}), std::invalid_argument);
+    EXPECT_THROW(eccpp::weight_enumerator(eccpp::gf2_matrix(64, 100)), std::invalid_argument);
+}
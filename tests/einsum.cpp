@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include "einsum.h"
+
+namespace {
+
+eccpp::mdarray<int> iota(const std::vector<size_t>& dims, int start = 1) {
+    eccpp::mdarray<int> m(dims);
+    for (size_t i = 0; i < m.size(); ++i)
+        m.data()[i] = start + int(i % 7) - 3;
+
+    return m;
+}
+
+} // namespace
+
+TEST(EinsumTest, MatrixProduct) {
+    const auto a = iota({5, 7});
+    const auto b = iota({7, 3}, 2);
+    EXPECT_EQ(eccpp::einsum("ij,jk->ik", a, b), a * b);
+
+    // contraction over lhs's first axis, i.e. a^T * c
+    const auto c = iota({5, 4}, 3);
+    const auto at_c = eccpp::einsum("ji,jk->ik", a, c);
+    ASSERT_EQ(at_c.dimensions(), std::vector<size_t>({7, 4}));
+    for (size_t i = 0; i < 7; ++i)
+        for (size_t k = 0; k < 4; ++k) {
+            int sum = 0;
+            for (size_t j = 0; j < 5; ++j)
+                sum += a({j, i}) * c({j, k});
+            EXPECT_EQ(at_c({i, k}), sum);
+        }
+}
+
+TEST(EinsumTest, TensorContraction) {
+    // same as mdarray's default contraction: last axis of lhs with the first axis of rhs
+    const auto a = iota({2, 3, 4});
+    const auto b = iota({4, 2, 5}, 5);
+    EXPECT_EQ(eccpp::einsum("abc,cde->abde", a, b), a * b);
+}
+
+TEST(EinsumTest, SingleOperand) {
+    const auto a = iota({3, 4});
+
+    const auto t = eccpp::einsum("ij->ji", a);
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            EXPECT_EQ(t({j, i}), a({i, j}));
+
+    const auto row_sums = eccpp::einsum("ij->i", a);
+    for (size_t i = 0; i < 3; ++i) {
+        int sum = 0;
+        for (size_t j = 0; j < 4; ++j)
+            sum += a({i, j});
+        EXPECT_EQ(row_sums({i}), sum);
+    }
+
+    const auto sq = iota({4, 4});
+    int trace = 0;
+    for (size_t i = 0; i < 4; ++i)
+        trace += sq({i, i});
+    EXPECT_EQ(eccpp::einsum("ii->", sq)({0}), trace);
+    EXPECT_EQ(eccpp::einsum("ii->i", sq)({2}), sq({2, 2}));
+}
+
+TEST(EinsumTest, BatchedAndOuter) {
+    // L paths x M elements, per-path dot product
+    const auto pm = iota({4, 6});
+    const auto llr = iota({4, 6}, 2);
+    const auto dots = eccpp::einsum("lm,lm->l", pm, llr);
+    for (size_t l = 0; l < 4; ++l) {
+        int sum = 0;
+        for (size_t m = 0; m < 6; ++m)
+            sum += pm({l, m}) * llr({l, m});
+        EXPECT_EQ(dots({l}), sum);
+    }
+
+    // element-wise product, all loops fuse into one
+    const auto prod = eccpp::einsum("lm,lm->lm", pm, llr);
+    for (size_t i = 0; i < prod.size(); ++i)
+        EXPECT_EQ(prod.data()[i], pm.data()[i] * llr.data()[i]);
+
+    const auto u = iota({3});
+    const auto v = iota({5}, 4);
+    const auto outer = eccpp::einsum("i,j->ij", u, v);
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 5; ++j)
+            EXPECT_EQ(outer({i, j}), u({i}) * v({j}));
+}
+
+TEST(EinsumTest, PlanReuse) {
+    const eccpp::contraction_plan plan("bij,bjk->bik", {3, 2, 4}, {3, 4, 5});
+    EXPECT_EQ(plan.operands(), 2);
+    EXPECT_EQ(plan.result_dimensions(), std::vector<size_t>({3, 2, 5}));
+
+    eccpp::mdarray<double> out({3, 2, 5});
+    for (int iter = 0; iter < 3; ++iter) {
+        eccpp::mdarray<double> a({3, 2, 4}), b({3, 4, 5});
+        for (size_t i = 0; i < a.size(); ++i)
+            a.data()[i] = double(i % 5) + iter;
+        for (size_t i = 0; i < b.size(); ++i)
+            b.data()[i] = double(i % 3) - iter;
+
+        plan.execute(a, b, out);
+        for (size_t bt = 0; bt < 3; ++bt)
+            for (size_t i = 0; i < 2; ++i)
+                for (size_t k = 0; k < 5; ++k) {
+                    double sum = 0;
+                    for (size_t j = 0; j < 4; ++j)
+                        sum += a({bt, i, j}) * b({bt, j, k});
+                    EXPECT_DOUBLE_EQ(out({bt, i, k}), sum);
+                }
+    }
+
+    eccpp::mdarray<double> wrong({3, 4, 4});
+    EXPECT_THROW(plan(wrong, wrong), std::invalid_argument);
+}
+
+TEST(EinsumTest, InvalidSpecThrows) {
+    const auto a = iota({2, 3});
+    const auto b = iota({4, 3});
+    EXPECT_THROW(eccpp::einsum("ij,jk", a, b), std::invalid_argument);
+    EXPECT_THROW(eccpp::einsum("ij,jk->ik", a, b), std::invalid_argument);
+    EXPECT_THROW(eccpp::einsum("ijk,kj->i", a, b), std::invalid_argument);
+    EXPECT_THROW(eccpp::einsum("ij->k", a), std::invalid_argument);
+    EXPECT_THROW(eccpp::einsum("ij->ii", a), std::invalid_argument);
+    EXPECT_THROW(eccpp::einsum("i1->i", a), std::invalid_argument);
+}
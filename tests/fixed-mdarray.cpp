@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+
+#include "fixed-mdarray.h"
+
+TEST(FixedMdarrayTest, Access) {
+    eccpp::fixed_mdarray<int, 3> a({2, 3, 4});
+    EXPECT_EQ(a.rank(), 3);
+    EXPECT_EQ(a.size(), 24);
+
+    for (size_t i = 0; i < 2; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            for (size_t k = 0; k < 4; ++k)
+                a(i, j, k) = int(i * 100 + j * 10 + k);
+
+    EXPECT_EQ(a(1, 2, 3), 123);
+    EXPECT_EQ(a.at(0, 1, 2), 12);
+    EXPECT_EQ(a.data()[4], 10);     // row-major
+
+    const auto& ca = a;
+    EXPECT_EQ(ca(1, 0, 1), 101);
+    EXPECT_EQ(ca.at(1, 1, 1), 111);
+
+    EXPECT_THROW(a.at(2, 0, 0), std::invalid_argument);
+    EXPECT_THROW(a.at(0, 3, 0), std::invalid_argument);
+    EXPECT_THROW(ca.at(0, 0, 4), std::invalid_argument);
+    EXPECT_THROW((eccpp::fixed_mdarray<int, 2>({3, 0})), std::invalid_argument);
+}
+
+TEST(FixedMdarrayTest, ConvertToAndFromDynamic) {
+    eccpp::mdarray<float> dyn({3, 5});
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 5; ++j)
+            dyn({i, j}) = float(i) - float(j) / 2;
+
+    // copying conversion
+    eccpp::fixed_mdarray<float, 2> copied(dyn);
+    EXPECT_EQ(copied(2, 3), dyn({2, 3}));
+    EXPECT_EQ(copied.to_mdarray(), dyn);
+
+    // moving conversion reuses the buffer
+    auto dyn_copy = dyn;
+    const float* buffer = dyn_copy.data();
+    eccpp::fixed_mdarray<float, 2> moved(std::move(dyn_copy));
+    EXPECT_EQ(moved.data(), buffer);
+    EXPECT_EQ(moved, copied);
+    EXPECT_TRUE(dyn_copy.dimensions().empty());
+    EXPECT_EQ(dyn_copy.size(), 0);
+
+    auto back = std::move(moved).to_mdarray();
+    EXPECT_EQ(back.data(), buffer);
+    EXPECT_EQ(back, dyn);
+
+    EXPECT_THROW((eccpp::fixed_mdarray<float, 3>(dyn)), std::invalid_argument);
+    EXPECT_THROW(eccpp::mdarray<float>({2, 2}, std::vector<float>(3)), std::invalid_argument);
+}
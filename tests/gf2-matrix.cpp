@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "gf2-matrix.h"
+#include "kron.h"
+#include "gn.h"
+#include "polar-enc.h"
+
+namespace {
+
+eccpp::mdarray<int> randomMatrix(size_t rows, size_t cols, std::minstd_rand& rng) {
+    eccpp::mdarray<int> m({rows, cols});
+    for (size_t r = 0; r < rows; ++r)
+        for (size_t c = 0; c < cols; ++c)
+            m({r, c}) = rng() & 1;
+
+    return m;
+}
+
+// reference GF(2) product over plain ints
+eccpp::mdarray<int> mulMod2(const eccpp::mdarray<int>& a, const eccpp::mdarray<int>& b) {
+    auto result = a * b;
+    const auto& dims = result.dimensions();
+    for (size_t r = 0; r < dims[0]; ++r)
+        for (size_t c = 0; c < dims[1]; ++c)
+            result({r, c}) &= 1;
+
+    return result;
+}
+
+} // namespace
+
+TEST(Gf2MatrixTest, ConvertRoundTrip) {
+    std::minstd_rand rng(1);
+    const auto m = randomMatrix(70, 130, rng);
+    const eccpp::gf2_matrix g(m);
+
+    EXPECT_EQ(g.rows(), 70);
+    EXPECT_EQ(g.cols(), 130);
+    EXPECT_EQ(g.words_per_row(), 3);
+    EXPECT_EQ(g.to_mdarray(), m);
+}
+
+TEST(Gf2MatrixTest, Products) {
+    std::minstd_rand rng(2);
+    for (auto [m, n, p]: std::vector<std::tuple<size_t, size_t, size_t>>{{1, 1, 1}, {3, 5, 7}, {64, 64, 64}, {65, 130, 67}, {100, 9, 200}}) {
+        const auto a = randomMatrix(m, n, rng);
+        const auto b = randomMatrix(n, p, rng);
+
+        const eccpp::gf2_matrix ga(a), gb(b);
+        EXPECT_EQ((ga * gb).to_mdarray(), mulMod2(a, b));
+
+        // vector-matrix and matrix-vector
+        std::vector<int> v(m), u(n);
+        for (auto& x: v)
+            x = rng() & 1;
+        for (auto& x: u)
+            x = rng() & 1;
+
+        eccpp::mdarray<int> row_v({1, m}), col_u({n, 1});
+        for (size_t i = 0; i < m; ++i)
+            row_v({0, i}) = v[i];
+        for (size_t i = 0; i < n; ++i)
+            col_u({i, 0}) = u[i];
+
+        const auto vA = eccpp::unpack_bits(eccpp::pack_bits(v) * ga, n);
+        const auto expected_vA = mulMod2(row_v, a);
+        for (size_t i = 0; i < n; ++i)
+            EXPECT_EQ(vA[i], expected_vA({0, i}));
+
+        // padding bits of a caller-built vector are ignored
+        auto dirty_v = eccpp::pack_bits(v);
+        dirty_v.back() |= ~eccpp::packed_tail_mask(m);
+        EXPECT_EQ(dirty_v * ga, eccpp::pack_bits(v) * ga);
+
+        const auto Au = eccpp::unpack_bits(ga * eccpp::pack_bits(u), m);
+        const auto expected_Au = mulMod2(a, col_u);
+        for (size_t i = 0; i < m; ++i)
+            EXPECT_EQ(Au[i], expected_Au({i, 0}));
+    }
+}
+
+TEST(Gf2MatrixTest, Transpose) {
+    std::minstd_rand rng(3);
+    for (auto [rows, cols]: std::vector<std::pair<size_t, size_t>>{{1, 1}, {5, 70}, {64, 64}, {130, 65}, {200, 3}}) {
+        const auto m = randomMatrix(rows, cols, rng);
+        const auto t = eccpp::gf2_matrix(m).transpose();
+        ASSERT_EQ(t.rows(), cols);
+        ASSERT_EQ(t.cols(), rows);
+
+        for (size_t r = 0; r < rows; ++r)
+            for (size_t c = 0; c < cols; ++c)
+                EXPECT_EQ(t(c, r), m({r, c}));
+
+        EXPECT_EQ(t.transpose(), eccpp::gf2_matrix(m));
+    }
+}
+
+TEST(Gf2MatrixTest, RankAndRowReduce) {
+    EXPECT_EQ(eccpp::gf2_matrix::identity(100).rank(), 100);
+    EXPECT_EQ(eccpp::gn_gf2(256).rank(), 256);
+    EXPECT_EQ(eccpp::gf2_matrix(10, 10).rank(), 0);
+
+    // duplicate and summed rows don't add to the rank
+    eccpp::mdarray<int> m({4, 3});
+    m({0, 0}) = 1; m({0, 1}) = 1; m({0, 2}) = 0;
+    m({1, 0}) = 0; m({1, 1}) = 1; m({1, 2}) = 1;
+    m({2, 0}) = 1; m({2, 1}) = 0; m({2, 2}) = 1;
+    m({3, 0}) = 1; m({3, 1}) = 1; m({3, 2}) = 0;
+    eccpp::gf2_matrix g(m);
+    EXPECT_EQ(g.rank(), 2);
+
+    EXPECT_EQ(g.row_reduce(), 2);
+    eccpp::mdarray<int> rref({4, 3});
+    rref({0, 0}) = 1; rref({0, 2}) = 1;
+    rref({1, 1}) = 1; rref({1, 2}) = 1;
+    EXPECT_EQ(g.to_mdarray(), rref);
+
+    // a full-rank random square matrix reduces to identity
+    std::minstd_rand rng(4);
+    auto gn = eccpp::gn_gf2(128) * eccpp::gf2_matrix(randomMatrix(128, 128, rng));
+    EXPECT_EQ(gn.rank(), 128u);
+    auto reduced = gn;
+    EXPECT_EQ(reduced.row_reduce(), 128u);
+    EXPECT_EQ(reduced, eccpp::gf2_matrix::identity(128));
+}
+
+TEST(Gf2MatrixTest, KronAndGn) {
+    std::minstd_rand rng(5);
+    const auto a = randomMatrix(3, 70, rng);
+    const auto b = randomMatrix(5, 7, rng);
+    EXPECT_EQ(eccpp::kron(eccpp::gf2_matrix(a), eccpp::gf2_matrix(b)).to_mdarray(), eccpp::kron(a, b));
+
+    for (size_t n = 1; n <= 256; n *= 2) {
+        const auto dense = eccpp::gn(n);
+        if (n == 1)
+            EXPECT_EQ(eccpp::gn_gf2(n), eccpp::gf2_matrix(dense));
+        else
+            EXPECT_EQ(eccpp::gn_gf2(n).to_mdarray(), dense);
+    }
+
+    // G_n is its own inverse in GF(2)
+    EXPECT_EQ(eccpp::gn_gf2(512) * eccpp::gn_gf2(512), eccpp::gf2_matrix::identity(512));
+}
+
+TEST(Gf2MatrixTest, PolarEncoder) {
+    for (std::uint_fast32_t seed: {0, 17}) {
+        eccpp::polar_enc_gf2 enc(128, seed);
+        eccpp::polar_enc_butterfly enc_bfly(128, seed);
+
+        std::vector<int> data(128);
+        for (size_t i = 0; i < 128; ++i)
+            data[i] = (i * 7 / 3) & 1;
+
+        EXPECT_EQ(enc.encode(data), enc_bfly.encode(data));
+    }
+
+    EXPECT_THROW(eccpp::polar_enc_gf2(eccpp::gf2_matrix(4, 8)), std::invalid_argument);
+}
+
+TEST(Gf2MatrixTest, Throws) {
+    EXPECT_THROW(eccpp::gf2_matrix(0, 5), std::invalid_argument);
+    EXPECT_THROW(eccpp::gf2_matrix(eccpp::mdarray<int>({2, 2, 2})), std::invalid_argument);
+
+    eccpp::gf2_matrix a(3, 4), b(5, 3);
+    EXPECT_THROW(a * b, std::invalid_argument);
+    EXPECT_THROW(a(3, 0), std::invalid_argument);
+    EXPECT_THROW(a + b, std::invalid_argument);
+    EXPECT_THROW(a * std::vector<std::uint64_t>(2), std::invalid_argument);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+#include "gn-cache.h"
+#include "polar-enc.h"
+
+TEST(GnCacheTest, SameHandleForSameN) {
+    auto a = eccpp::gn_cached(64);
+    auto b = eccpp::gn_cached(64);
+
+    EXPECT_EQ(a.get(), b.get());
+    EXPECT_EQ(*a, eccpp::gn(64));
+    EXPECT_TRUE(eccpp::gn_cache().contains(64));
+    EXPECT_EQ(*eccpp::gn_csc_cached(64), eccpp::gn_csc(64));
+    EXPECT_EQ(*eccpp::gn_gf2_cached(64), eccpp::gn_gf2(64));
+}
+
+TEST(GnCacheTest, EncodersShareGenerator) {
+    eccpp::polar_enc_gf2 a(128, 1);
+    eccpp::polar_enc_gf2 b(128, 2);
+    EXPECT_EQ(&a.generator(), &b.generator());
+
+    eccpp::polar_enc_sparse c(128);
+    eccpp::polar_enc_sparse d(128, 5);
+    EXPECT_EQ(&c.generator(), &d.generator());
+}
+
+TEST(GnCacheTest, ConcurrentCallersBuildOnce) {
+    std::atomic<int> builds{0};
+    eccpp::generator_cache<eccpp::mdarray<int>> cache([&](size_t n) {
+        ++builds;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        return eccpp::gn(n);
+    });
+
+    std::vector<std::shared_ptr<const eccpp::mdarray<int>>> handles(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < handles.size(); ++i)
+        threads.emplace_back([&, i] { handles[i] = cache.get(256); });
+    for (auto& t: threads)
+        t.join();
+
+    EXPECT_EQ(builds, 1);
+    for (const auto& h: handles)
+        EXPECT_EQ(h.get(), handles[0].get());
+}
+
+TEST(GnCacheTest, EvictsLeastRecentlyUsed) {
+    eccpp::generator_cache<eccpp::mdarray<int>> cache([](size_t n) { return eccpp::gn(n); });
+    const size_t bytes64 = 64 * 64 * sizeof(int);
+
+    cache.set_memory_limit(2 * bytes64);
+    auto first = cache.get(64);
+    auto second = cache.get(32);
+    cache.get(64);          // 64 is now the most recently used
+    EXPECT_EQ(cache.memory_usage(), bytes64 + 32 * 32 * sizeof(int));
+
+    cache.get(16);
+    EXPECT_TRUE(cache.contains(64));
+    EXPECT_TRUE(cache.contains(32));
+
+    cache.set_memory_limit(bytes64 + 16 * 16 * sizeof(int));
+    EXPECT_TRUE(cache.contains(64));
+    EXPECT_FALSE(cache.contains(32));
+    EXPECT_TRUE(cache.contains(16));
+    EXPECT_LE(cache.memory_usage(), cache.memory_limit());
+
+    // handles given out before the eviction stay valid
+    EXPECT_EQ(*second, eccpp::gn(32));
+    EXPECT_NE(cache.get(32).get(), second.get());
+
+    cache.clear();
+    EXPECT_FALSE(cache.contains(64));
+    EXPECT_EQ(cache.memory_usage(), 0u);
+    EXPECT_EQ(*first, eccpp::gn(64));
+}
+
+TEST(GnCacheTest, FailedBuildIsRetried) {
+    int builds = 0;
+    eccpp::generator_cache<eccpp::mdarray<int>> cache([&](size_t n) {
+        if (++builds == 1)
+            throw std::runtime_error("out of memory");
+        return eccpp::gn(n);
+    });
+
+    EXPECT_THROW(cache.get(8), std::runtime_error);
+    EXPECT_FALSE(cache.contains(8));
+    EXPECT_EQ(*cache.get(8), eccpp::gn(8));
+    EXPECT_EQ(builds, 2);
+
+    EXPECT_THROW(eccpp::gn_cached(3), std::invalid_argument);
+}
+
+TEST(GnCacheTest, ClearDuringBuildsKeepsAccounting) {
+    // clear() racing with builds must not leave bytes behind for entries that are gone
+    eccpp::generator_cache<eccpp::mdarray<int>> cache([](size_t n) { return eccpp::gn(n); });
+    std::atomic<bool> stop{false};
+    std::thread clearer([&] {
+        while (!stop)
+            cache.clear();
+    });
+
+    std::vector<std::thread> callers;
+    for (size_t t = 0; t < 3; ++t)
+        callers.emplace_back([&, t] {
+            for (int i = 0; i < 300; ++i)
+                EXPECT_EQ(cache.get(size_t(8) << ((i + t) % 3))->dimensions()[0], size_t(8) << ((i + t) % 3));
+        });
+    for (auto& c: callers)
+        c.join();
+    stop = true;
+    clearer.join();
+
+    size_t expected = 0;
+    for (size_t n: {8, 16, 32})
+        if (cache.contains(n))
+            expected += n * n * sizeof(int);
+    EXPECT_EQ(cache.memory_usage(), expected);
+
+    cache.clear();
+    EXPECT_EQ(cache.memory_usage(), 0u);
+}
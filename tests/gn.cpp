@@ -34,4 +34,69 @@ TEST(GnTest, N4) {
     auto result = eccpp::gn(4);
 
     EXPECT_EQ(result, expected);
-}
\ No newline at end of file
+}
+
+TEST(GnTest, ViewMatchesDense) {
+    for (size_t n = 1; n <= 128; n *= 2) {
+        const auto dense = eccpp::gn(n);
+        const eccpp::gn_view view(n);
+        ASSERT_EQ(view.size(), n);
+        EXPECT_EQ(view.to_mdarray(), dense);
+
+        if (n == 1) {
+            EXPECT_EQ(view(0, 0), 1);
+            continue;
+        }
+
+        for (size_t r = 0; r < n; ++r) {
+            const auto row = view.row(r);
+            const auto packed = view.packed_row(r);
+            size_t weight = 0;
+            for (size_t c = 0; c < n; ++c) {
+                EXPECT_EQ(view(r, c), dense({r, c}));
+                EXPECT_EQ(row[c], dense({r, c}));
+                EXPECT_EQ(view.column(c)[r], dense({r, c}));
+                EXPECT_EQ(int((packed[c / 64] >> (c % 64)) & 1), dense({r, c}));
+                weight += dense({r, c});
+            }
+            EXPECT_EQ(view.row_weight(r), weight);
+        }
+
+        for (size_t c = 0; c < n; ++c) {
+            size_t weight = 0;
+            for (size_t r = 0; r < n; ++r)
+                weight += dense({r, c});
+
+            EXPECT_EQ(view.column_weight(c), weight);
+        }
+    }
+}
+
+TEST(GnTest, ViewThrows) {
+    EXPECT_THROW(eccpp::gn_view(0), std::invalid_argument);
+    EXPECT_THROW(eccpp::gn_view(6), std::invalid_argument);
+
+    const eccpp::gn_view view(8);
+    EXPECT_THROW(view.at(8, 0), std::invalid_argument);
+    EXPECT_THROW(view.row(8), std::invalid_argument);
+    EXPECT_THROW(view.packed_row(9), std::invalid_argument);
+}
+
+TEST(GnTest, SparseMatchesDense) {
+    for (size_t n: {1, 2, 8, 64}) {
+        const auto dense = eccpp::gn(n);
+        const auto csr = eccpp::gn_csr(n);
+        const auto csc = eccpp::gn_csc(n);
+
+        if (n > 1) {
+            EXPECT_EQ(csr, eccpp::csr_matrix<int>(dense));
+            EXPECT_EQ(csc, eccpp::csc_matrix<int>(dense));
+        }
+        EXPECT_EQ(csr.to_csc(), csc);
+
+        size_t nonzeros = 1;
+        for (size_t m = n; m > 1; m /= 2)
+            nonzeros *= 3;
+        EXPECT_EQ(csr.nonzeros(), nonzeros);
+    }
+}
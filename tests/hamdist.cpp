@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
+#include <random>
 
 #include "hamdist.h"
+#include "hamweight.h"
 
 TEST(HamdistTest, Basic) {
     eccpp::mdarray<int> a({2, 2});
@@ -57,3 +59,87 @@ TEST(HamdistTest, DifferentSizes) {
     EXPECT_THROW(eccpp::hamdist(a, c), std::invalid_argument);
     EXPECT_THROW(eccpp::hamdist(b, c), std::invalid_argument);
 }
+
+TEST(HamdistTest, PackedMatchesUnpacked) {
+    std::mt19937 rng(1);
+
+    // sizes around the word, the 4 word AVX2 block, the 8 word AVX-512 block and the 16 block
+    // Harley-Seal step
+    for (size_t n: {0, 1, 63, 64, 65, 255, 256, 300, 1024, 1100, 4096, 5000}) {
+        std::vector<int> a(n), b(n);
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = int(rng() & 1);
+            b[i] = int(rng() % 5 == 0);
+        }
+
+        const auto pa = eccpp::pack_bits(a);
+        const auto pb = eccpp::pack_bits(b);
+        EXPECT_EQ(eccpp::hamdist_packed(pa, pb), eccpp::hamdist(a, b));
+        EXPECT_EQ(eccpp::hamweight_packed(pa), eccpp::hamweight(a));
+        EXPECT_EQ(eccpp::hamweight_packed(pb), eccpp::hamweight(b));
+    }
+
+    const std::vector<std::uint64_t> ones(40, ~std::uint64_t(0));
+    EXPECT_EQ(eccpp::hamweight_packed(ones), 40u * 64u);
+    EXPECT_EQ(eccpp::hamdist_packed(ones, std::vector<std::uint64_t>(40)), 40u * 64u);
+    EXPECT_THROW(eccpp::hamdist_packed(ones, std::vector<std::uint64_t>(39)), std::invalid_argument);
+}
+
+TEST(HamdistTest, PackedOneToMany) {
+    std::mt19937 rng(2);
+    const size_t n = 200;
+    const size_t count = 33;
+
+    std::vector<int> a(n);
+    for (auto& v: a)
+        v = int(rng() & 1);
+    const auto pa = eccpp::pack_bits(a);
+
+    std::vector<std::vector<int>> others(count, std::vector<int>(n));
+    std::vector<std::uint64_t> many;
+    for (auto& other: others) {
+        for (auto& v: other)
+            v = int(rng() & 1);
+        const auto packed = eccpp::pack_bits(other);
+        many.insert(many.end(), packed.begin(), packed.end());
+    }
+
+    std::vector<size_t> distances(count);
+    eccpp::hamdist_packed(pa, many, distances);
+    for (size_t i = 0; i < count; ++i)
+        EXPECT_EQ(distances[i], eccpp::hamdist(a, others[i]));
+
+    std::vector<size_t> too_many(count + 1);
+    EXPECT_THROW(eccpp::hamdist_packed(pa, many, too_many), std::invalid_argument);
+}
+
+TEST(HamdistTest, PopcountKernelsAgree) {
+    using eccpp::detail::popcount_isa;
+    std::mt19937_64 rng(3);
+    std::vector<std::uint64_t> a(600), b(600);
+    for (auto& w: a)
+        w = rng();
+    for (auto& w: b)
+        w = rng();
+
+    EXPECT_TRUE(eccpp::detail::popcount_isa_supported(popcount_isa::generic));
+    EXPECT_TRUE(eccpp::detail::popcount_isa_supported(eccpp::detail::popcount_best_isa()));
+
+    // every kernel the CPU can run, on lengths around their block sizes and tails
+    for (auto isa: {popcount_isa::generic, popcount_isa::popcnt, popcount_isa::avx2, popcount_isa::avx512}) {
+        if (!eccpp::detail::popcount_isa_supported(isa))
+            continue;
+
+        const auto weight = eccpp::detail::popcount_words_kernel<false>(isa);
+        const auto distance = eccpp::detail::popcount_words_kernel<true>(isa);
+        for (size_t n: {0, 1, 3, 4, 7, 8, 9, 15, 16, 63, 64, 65, 67, 100, 600}) {
+            std::uint64_t expected_weight = 0, expected_distance = 0;
+            for (size_t i = 0; i < n; ++i) {
+                expected_weight += std::uint64_t(std::popcount(a[i]));
+                expected_distance += std::uint64_t(std::popcount(a[i] ^ b[i]));
+            }
+            EXPECT_EQ(weight(a.data(), a.data(), n), expected_weight) << int(isa) << " " << n;
+            EXPECT_EQ(distance(a.data(), b.data(), n), expected_distance) << int(isa) << " " << n;
+        }
+    }
+}
@@ -1,7 +1,34 @@
 #include <gtest/gtest.h>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <ostream>
 
 #include "mdarray.h"
 #include "kron.h"
+#include "gn.h"
+#include "polar-enc.h"
+
+namespace {
+
+// an int that records which threads multiplied it
+struct thread_tracked {
+    int value = 0;
+
+    static inline std::mutex mutex;
+    static inline std::set<std::thread::id> threads;
+
+    friend thread_tracked operator*(thread_tracked a, thread_tracked b) {
+        std::lock_guard lock(mutex);
+        threads.insert(std::this_thread::get_id());
+        return {a.value * b.value};
+    }
+    thread_tracked& operator*=(thread_tracked other) { return *this = *this * other; }
+    bool operator==(const thread_tracked&) const = default;
+    friend std::ostream& operator<<(std::ostream& os, thread_tracked x) { return os << x.value; }
+};
+
+} // namespace
 
 class KroneckerProductTest : public ::testing::Test {
 protected:
@@ -284,3 +311,98 @@ TEST_F(KroneckerProductTest, IdentityMatrixProperty) {
 
     EXPECT_EQ(result, I4);
 }
+
+TEST_F(KroneckerProductTest, LazyViewMatchesDense) {
+    // non-square factors of different sizes
+    eccpp::mdarray<int> a({2, 3}), b({3, 2}), c({2, 2});
+    for (size_t i = 0; i < 6; ++i) {
+        a.data()[i] = int(i) - 2;
+        b.data()[i] = int(i * i % 5);
+    }
+    c.data()[0] = 1; c.data()[1] = -1; c.data()[2] = 2; c.data()[3] = 3;
+
+    const eccpp::kron_view<int> view({a, b, c});
+    const auto dense = eccpp::kron(eccpp::kron(a, b), c);
+    EXPECT_EQ(view.dimensions(), dense.dimensions());
+    EXPECT_EQ(view.to_mdarray(), dense);
+    EXPECT_EQ(view(11, 7), dense({11, 7}));
+    EXPECT_THROW(view(12, 0), std::invalid_argument);
+
+    std::vector<int> x(view.cols()), y(view.rows());
+    for (size_t i = 0; i < x.size(); ++i)
+        x[i] = int(i % 7) - 3;
+    for (size_t i = 0; i < y.size(); ++i)
+        y[i] = int(i % 4);
+
+    // dense reference products
+    std::vector<int> ax(view.rows()), yta(view.cols());
+    for (size_t r = 0; r < view.rows(); ++r)
+        for (size_t col = 0; col < view.cols(); ++col) {
+            ax[r] += dense({r, col}) * x[col];
+            yta[col] += y[r] * dense({r, col});
+        }
+
+    EXPECT_EQ(view * x, ax);
+    EXPECT_EQ(view.transpose_multiply(y), yta);
+    EXPECT_THROW(view.multiply(std::vector<int>(5)), std::invalid_argument);
+    EXPECT_THROW(eccpp::kron_view<int>({}), std::invalid_argument);
+}
+
+TEST_F(KroneckerProductTest, LazyGnMatchesEncoder) {
+    const size_t n = 256;
+    const auto gn = eccpp::gn_kron_view(n);
+    EXPECT_EQ(gn.to_mdarray(), eccpp::gn(n));
+    EXPECT_EQ(eccpp::gn_kron_view(1).to_mdarray(), eccpp::mdarray<int>({1, 1}, std::vector<int>{1}));
+
+    std::vector<int> data(n);
+    for (size_t i = 0; i < n; ++i)
+        data[i] = int((i * 37) % 5 < 2);
+
+    EXPECT_EQ(gn.gf2_transpose_multiply(data), eccpp::polar_enc_butterfly(n).encode(data));
+}
+
+TEST_F(KroneckerProductTest, VariadicMatchesPairwise) {
+    eccpp::mdarray<double> a({2, 3}), b({3, 1}), c({2, 2}), d({1, 4});
+    for (auto* m: {&a, &b, &c, &d})
+        for (size_t i = 0; i < m->size(); ++i)
+            m->data()[i] = double(i + 1) * (m == &c ? -0.5 : 1.5) + (m == &b ? 0.0 : double(i == 1));
+
+    const auto pairwise = eccpp::kron(eccpp::kron(eccpp::kron(a, b), c), d);
+    EXPECT_EQ(eccpp::kron(a, b, c, d), pairwise);
+    EXPECT_EQ(eccpp::kron(eccpp::execution::par(3), a, b, c, d), pairwise);
+    EXPECT_EQ(eccpp::kron(a), a);
+    EXPECT_EQ(eccpp::kron_view<double>({a, b, c, d}).to_mdarray(eccpp::execution::par), pairwise);
+
+    // G_n built in one pass matches repeated pairwise products
+    auto g = eccpp::gn(2);
+    for (size_t n = 4; n <= 64; n *= 2) {
+        g = eccpp::kron(g, eccpp::gn(2));
+        EXPECT_EQ(eccpp::gn(n), g);
+    }
+
+    eccpp::mdarray<double> bad({2, 2, 2});
+    EXPECT_THROW(eccpp::kron(a, b, bad), std::invalid_argument);
+}
+
+TEST_F(KroneckerProductTest, ParallelSplitsRows) {
+    // ranges of whole items, a thread per 3 of them at most
+    std::mutex mutex;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    eccpp::detail::for_each_range(eccpp::execution::par(8), 10, 1, 3, [&](size_t begin, size_t end) {
+        std::lock_guard lock(mutex);
+        ranges.emplace_back(begin, end);
+    });
+    std::sort(ranges.begin(), ranges.end());
+    EXPECT_EQ(ranges, (std::vector<std::pair<size_t, size_t>>{{0, 3}, {3, 6}, {6, 9}, {9, 10}}));
+
+    // G_256 is 65536 elements, enough for 2 threads of 128 rows
+    const thread_tracked zero{0}, one{1};
+    const eccpp::mdarray<thread_tracked> g2({2, 2}, std::vector<thread_tracked>{one, zero, one, one});
+    const auto expected = eccpp::kron(g2, g2, g2, g2, g2, g2, g2, g2);
+    thread_tracked::threads.clear();
+    EXPECT_EQ(eccpp::kron(eccpp::execution::par(3), g2, g2, g2, g2, g2, g2, g2, g2), expected);
+    EXPECT_EQ(thread_tracked::threads.size(), 2u);
+
+    EXPECT_EQ(eccpp::gn(eccpp::execution::par(2), 256), eccpp::gn(256));
+    EXPECT_EQ(eccpp::kron_view<int>::power(eccpp::gn(2), 9).to_mdarray(eccpp::execution::par), eccpp::gn(512));
+}
@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <numeric>
+
+#include "ldpc-enc.h"
+#include "ldpc-dec.h"
+
+namespace {
+
+// rate 1/2, n = 648 (z = 27) in the 802.11n layout: dual-diagonal parity part in the last 12 columns
+eccpp::qc_ldpc_code wifi_code() {
+    const std::vector<int> base = {
+         0, -1, -1, -1,  0,  0, -1, -1,  0, -1, -1,  0,  1,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        22,  0, -1, -1, 17, -1,  0,  0, 12, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+         6, -1,  0, -1, 10, -1, -1, -1, 24, -1,  0, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1, -1, -1, -1,
+         2, -1, -1,  0, 20, -1, -1, -1, 25,  0, -1, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1, -1, -1,
+        23, -1, -1, -1,  3, -1, -1, -1,  0, -1,  9, 11, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1, -1,
+        24, -1, 23,  1, 17, -1,  3, -1, 10, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1, -1,
+        25, -1, -1, -1,  8, -1, -1, -1,  7, 18, -1, -1,  0, -1, -1, -1, -1, -1,  0,  0, -1, -1, -1, -1,
+        13, 24, -1, -1,  0, -1,  8, -1,  6, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0, -1, -1, -1,
+         7, 20, -1, 16, 22, 10, -1, -1, 23, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0, -1, -1,
+        11, -1, -1, -1, 19, -1, -1, -1, 13, -1,  3, 17, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0, -1,
+        25, -1,  8, -1, 23, 18, -1, 14,  9, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  0,
+         3, -1, -1, -1, 16, -1, -1,  2, 25,  5, -1, -1,  1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,
+    };
+    return eccpp::qc_ldpc_code(eccpp::mdarray<int>({12, 24}, base), 27);
+}
+
+std::vector<int> random_bits(size_t n, std::mt19937& rng) {
+    std::vector<int> bits(n);
+    for (auto& b: bits)
+        b = int(rng() & 1);
+    return bits;
+}
+
+// BPSK over AWGN, 0 -> +1, LLR = 2 y / sigma^2
+std::vector<float> awgn_llr(const std::vector<int>& codeword, float sigma, std::mt19937& rng) {
+    std::normal_distribution<float> noise(0.0f, sigma);
+    std::vector<float> llr(codeword.size());
+    for (size_t i = 0; i < codeword.size(); ++i)
+        llr[i] = 2 * ((codeword[i] ? -1.0f : 1.0f) + noise(rng)) / (sigma * sigma);
+    return llr;
+}
+
+const eccpp::minstar_mode all_modes[] = {eccpp::minstar_mode::exact, eccpp::minstar_mode::jacobian_lut,
+    eccpp::minstar_mode::offset_min_sum, eccpp::minstar_mode::normalized_min_sum};
+
+}
+
+TEST(LdpcTest, ThrowOnBadBase) {
+    using eccpp::mdarray;
+    EXPECT_THROW(eccpp::qc_ldpc_code(mdarray<int>({1, 2}, std::vector<int>{0, 1}), 0), std::invalid_argument);
+    EXPECT_THROW(eccpp::qc_ldpc_code(mdarray<int>({1, 2}, std::vector<int>{0, 4}), 4), std::invalid_argument);
+    EXPECT_THROW(eccpp::qc_ldpc_code(mdarray<int>({1, 2}, std::vector<int>{0, -2}), 4), std::invalid_argument);
+    EXPECT_THROW(eccpp::qc_ldpc_code(mdarray<int>({2, 2}, std::vector<int>{0, 1, -1, 3}), 4), std::invalid_argument);
+    EXPECT_THROW(eccpp::qc_ldpc_code(mdarray<int>({2}, std::vector<int>{0, 1}), 4), std::invalid_argument);
+}
+
+TEST(LdpcTest, ParityCheckMatchesBase) {
+    // the second row is the sum of the first and the third one, so the rank is 2 * z, not 3 * z
+    const size_t z = 5;
+    eccpp::qc_ldpc_code code(eccpp::mdarray<int>({3, 4}, std::vector<int>{
+        0, 2, -1, -1,
+        0, 2, 1, 3,
+        -1, -1, 1, 3}), z);
+
+    EXPECT_EQ(code.n(), 20u);
+    EXPECT_EQ(code.checks(), 15u);
+    EXPECT_EQ(code.k(), 10u);
+    EXPECT_EQ(code.parity_bits().size(), 10u);
+    EXPECT_EQ(code.layers()[1].size(), 4u);
+
+    const auto h = code.parity_check().to_mdarray();
+    for (size_t i = 0; i < z; ++i)
+        for (size_t j = 0; j < z; ++j) {
+            EXPECT_EQ(h({i, j}), int(j == i));
+            EXPECT_EQ(h({z + i, z + j}), int(j == (i + 2) % z));
+            EXPECT_EQ(h({2 * z + i, 3 * z + j}), int(j == (i + 3) % z));
+            EXPECT_EQ(h({2 * z + i, j}), 0);
+        }
+}
+
+TEST(LdpcTest, EncodeGivesSystematicCodewords) {
+    const auto code = wifi_code();
+    EXPECT_EQ(code.n(), 648u);
+    EXPECT_EQ(code.k(), 324u);
+
+    std::vector<size_t> first_half(324);
+    std::iota(first_half.begin(), first_half.end(), size_t(0));
+    EXPECT_EQ(code.info_bits(), first_half);
+
+    eccpp::ldpc_enc enc(code);
+    std::mt19937 rng(1);
+    for (int i = 0; i < 20; ++i) {
+        const auto msg = random_bits(code.k(), rng);
+        const auto codeword = enc.encode(msg);
+        EXPECT_TRUE(code.is_codeword(codeword));
+        EXPECT_EQ(std::vector<int>(codeword.begin(), codeword.begin() + 324), msg);
+    }
+
+    auto broken = enc.encode(random_bits(code.k(), rng));
+    broken[100] ^= 1;
+    EXPECT_FALSE(code.is_codeword(broken));
+    const auto syndrome = code.syndrome(broken);
+    EXPECT_EQ(std::accumulate(syndrome.begin(), syndrome.end(), 0), 3);     // weight of base column 3
+
+    EXPECT_THROW(enc.encode(std::vector<int>(323)), std::invalid_argument);
+}
+
+TEST(LdpcTest, DecodeAwgnAndErasures) {
+    const auto code = wifi_code();
+    eccpp::ldpc_enc enc(code);
+    std::mt19937 rng(2);
+
+    for (auto mode: all_modes) {
+        eccpp::ldpc_dec<float> dec(code, 20, {mode, 0.5f, 0.75f});
+
+        // Eb/N0 = 3 dB at rate 1/2 is well into the waterfall for n = 648
+        for (int i = 0; i < 10; ++i) {
+            const auto msg = random_bits(code.k(), rng);
+            const auto codeword = enc.encode(msg);
+            const auto result = dec.decode(awgn_llr(codeword, 0.708f, rng));
+            EXPECT_TRUE(result.success);
+            EXPECT_EQ(result.msg, msg);
+            EXPECT_EQ(result.codeword, codeword);
+        }
+
+        // 25% of the bits erased
+        const auto msg = random_bits(code.k(), rng);
+        const auto codeword = enc.encode(msg);
+        std::vector<float> llr(code.n());
+        for (size_t i = 0; i < code.n(); ++i)
+            llr[i] = rng() % 4 == 0 ? 0.0f : (codeword[i] ? -10.0f : 10.0f);
+
+        const auto result = dec.decode(llr);
+        EXPECT_TRUE(result.success);
+        EXPECT_EQ(result.msg, msg);
+    }
+}
+
+TEST(LdpcTest, EarlyTermination) {
+    const auto code = wifi_code();
+    eccpp::ldpc_enc enc(code);
+    eccpp::ldpc_dec<float> dec(code, 50);
+    std::mt19937 rng(3);
+
+    const auto codeword = enc.encode(random_bits(code.k(), rng));
+    std::vector<float> llr(code.n());
+    for (size_t i = 0; i < code.n(); ++i)
+        llr[i] = codeword[i] ? -1.0f : 1.0f;
+
+    const auto clean = dec.decode(llr);
+    EXPECT_TRUE(clean.success);
+    EXPECT_EQ(clean.iterations, 0u);
+
+    llr[5] = -llr[5];
+    llr[400] = -llr[400];
+    const auto fixed = dec.decode(llr);
+    EXPECT_TRUE(fixed.success);
+    EXPECT_EQ(fixed.codeword, codeword);
+    EXPECT_GE(fixed.iterations, 1u);
+    EXPECT_LE(fixed.iterations, 5u);
+
+    // pure noise never satisfies the checks, so it runs for max_iterations
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    for (auto& v: llr)
+        v = noise(rng);
+    const auto garbage = dec.decode(llr);
+    EXPECT_FALSE(garbage.success);
+    EXPECT_EQ(garbage.iterations, 50u);
+
+    EXPECT_THROW(dec.decode(std::vector<float>(647)), std::invalid_argument);
+}
+
+TEST(LdpcTest, BatchMatchesSingleFrame) {
+    const auto code = wifi_code();
+    eccpp::ldpc_enc enc(code);
+    std::mt19937 rng(4);
+
+    // 37 frames: two full groups of lanes and a partial one. Noise high enough for some failures
+    std::vector<std::vector<float>> llrs;
+    for (int i = 0; i < 37; ++i)
+        llrs.push_back(awgn_llr(enc.encode(random_bits(code.k(), rng)), 0.85f, rng));
+
+    for (auto mode: all_modes) {
+        eccpp::ldpc_dec<float> dec(code, 15, {mode, 0.5f, 0.75f});
+        const auto batch = dec.decode(llrs);
+        ASSERT_EQ(batch.size(), llrs.size());
+
+        for (size_t i = 0; i < llrs.size(); ++i) {
+            const auto single = dec.decode(llrs[i]);
+            EXPECT_EQ(batch[i].codeword, single.codeword);
+            EXPECT_EQ(batch[i].iterations, single.iterations);
+            EXPECT_EQ(batch[i].success, single.success);
+        }
+    }
+}
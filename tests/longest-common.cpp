@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <random>
 
 #include "longest-common.h"
 
@@ -45,3 +46,86 @@ TEST(LcTest, Basic) {
     EXPECT_EQ(eccpp::lc_aligned_run(a, b), 4);
     EXPECT_EQ(eccpp::lc_aligned_run(b, a), 4);
 }
+
+TEST(LcTest, BitParallelMatchesScalar) {
+    std::mt19937 rng(1);
+
+    // edge sizes around the word boundaries, with random alphabets of 1 to 5 values
+    const size_t sizes[] = {0, 1, 2, 63, 64, 65, 127, 130, 200};
+    for (auto n: sizes)
+        for (auto m: sizes) {
+            const unsigned alphabet = 1 + rng() % 5;
+            std::vector<int> a(n), b(m);
+            for (auto& x: a)
+                x = int(rng() % alphabet) * 7 - 3;
+            for (auto& x: b)
+                x = int(rng() % alphabet) * 7 - 3;
+
+            // a long common run now and then, straddling words
+            if (rng() % 2 && n > 10 && m > 10) {
+                const size_t len = std::min(n, m) / 2;
+                std::copy(a.begin() + (n - len) / 3, a.begin() + (n - len) / 3 + len, b.begin() + (m - len));
+            }
+
+            EXPECT_EQ(eccpp::lc_run_bitparallel(a, b), eccpp::lc_run(a, b)) << n << " " << m;
+            EXPECT_EQ(eccpp::lc_run_bitparallel(b, a), eccpp::lc_run(b, a)) << n << " " << m;
+            EXPECT_EQ(eccpp::lc_subseq_bitparallel(a, b), eccpp::lc_subseq(a, b)) << n << " " << m;
+            EXPECT_EQ(eccpp::lc_subseq_bitparallel(b, a), eccpp::lc_subseq(b, a)) << n << " " << m;
+        }
+
+    // identical sequences, the whole thing is a single run
+    std::vector<int> a(300);
+    for (auto& x: a)
+        x = int(rng() & 1);
+    EXPECT_EQ(eccpp::lc_run_bitparallel(a, a), 300u);
+    EXPECT_EQ(eccpp::lc_subseq_bitparallel(a, a), 300u);
+}
+
+TEST(LcTest, BitParallelThrowOnLargeAlphabet) {
+    std::vector<int> a(eccpp::lc_max_alphabet);
+    for (size_t i = 0; i < a.size(); ++i)
+        a[i] = int(i);
+    const std::vector<int> b = {-1};
+    EXPECT_NO_THROW(eccpp::lc_run_bitparallel(a, a));
+    EXPECT_THROW(eccpp::lc_run_bitparallel(a, b), std::invalid_argument);
+    EXPECT_THROW(eccpp::lc_subseq_bitparallel(b, a), std::invalid_argument);
+}
+
+TEST(LcTest, PackedAlignedRunMatchesUnpacked) {
+    std::mt19937 rng(2);
+    for (size_t bits: {0, 1, 5, 63, 64, 65, 128, 200, 256}) {
+        // a few codewords close to each other, so the runs are long and cross words
+        const size_t count = 6;
+        std::vector<std::vector<int>> codebook(count, std::vector<int>(bits));
+        std::vector<std::uint64_t> many;
+        for (auto& codeword: codebook) {
+            for (auto& bit: codeword)
+                bit = rng() % 8 == 0;
+            const auto packed = eccpp::pack_bits(codeword);
+            many.insert(many.end(), packed.begin(), packed.end());
+        }
+
+        std::vector<int> a(bits);
+        for (auto& bit: a)
+            bit = rng() % 8 == 0;
+        const auto pa = eccpp::pack_bits(a);
+
+        size_t expected_max = 0;
+        for (const auto& codeword: codebook) {
+            const auto expected = eccpp::lc_aligned_run<int, size_t>(a, codeword);
+            EXPECT_EQ(eccpp::lc_aligned_run_packed(pa, eccpp::pack_bits(codeword), bits), expected) << bits;
+            expected_max = std::max(expected_max, expected);
+        }
+        EXPECT_EQ(eccpp::lc_aligned_run_packed_max(pa, many, bits), expected_max) << bits;
+        EXPECT_EQ(eccpp::lc_aligned_run_packed(pa, pa, bits), bits);
+    }
+
+    // padding bits must not extend a run: 70 equal bits, the rest of the second word differs in the
+    // padding only
+    const std::vector<std::uint64_t> a = {0, 0}, b = {0, ~std::uint64_t(0) << 6};
+    EXPECT_EQ(eccpp::lc_aligned_run_packed(a, b, 70), 70u);
+    EXPECT_EQ(eccpp::lc_aligned_run_packed(a, b, 71), 70u);
+
+    EXPECT_THROW(eccpp::lc_aligned_run_packed(a, b, 129), std::invalid_argument);
+    EXPECT_THROW(eccpp::lc_aligned_run_packed_max(a, std::vector<std::uint64_t>(3), 128), std::invalid_argument);
+}
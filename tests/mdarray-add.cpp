@@ -235,3 +235,55 @@ TEST_F(MdarrayAddTest, ChainedAdd) {
         }
     }
 }
+
+TEST_F(MdarrayAddTest, FusedExpressions) {
+    eccpp::mdarray<int> A = createMatrix2x3();
+    eccpp::mdarray<int> B = createMatrix2x3B();
+    eccpp::mdarray<int> C = create3DTensor();
+
+    eccpp::mdarray<int> D = A + B - A * 2 + -B / 2;
+    for (size_t i = 0; i < 2; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            EXPECT_EQ(D({i, j}), A({i, j}) + B({i, j}) - A({i, j}) * 2 + -B({i, j}) / 2);
+
+    // assignment into an existing array of the same shape reuses its buffer,
+    // including when the destination is one of the operands
+    const int* buffer = D.data();
+    D = 3 * (D - A) + D;
+    EXPECT_EQ(D.data(), buffer);
+
+    // and re-allocates when the shape changes
+    D = C + C;
+    EXPECT_EQ(D, C * 2);
+
+    // dimension mismatch is detected deep inside an expression too
+    EXPECT_THROW(A + B - C, std::invalid_argument);
+    EXPECT_THROW(A += B + C, std::invalid_argument);
+
+    // contraction of an expression evaluates it first
+    eccpp::mdarray<int> E = createMatrix3x2();
+    EXPECT_EQ((A + B) * E, (A * E) + (B * E));
+}
+
+TEST_F(MdarrayAddTest, TemporaryBufferReuse) {
+    eccpp::mdarray<int> A = createMatrix2x3();
+    eccpp::mdarray<int> B = createMatrix2x3B();
+
+    auto tmp = A;
+    const int* buffer = tmp.data();
+    eccpp::mdarray<int> result = std::move(tmp) + B - A;
+    EXPECT_EQ(result.data(), buffer);
+    EXPECT_EQ(result, B);
+
+    tmp = B;
+    buffer = tmp.data();
+    result = A - std::move(tmp);
+    EXPECT_EQ(result.data(), buffer);
+    EXPECT_EQ(result, -(B - A));
+
+    tmp = A;
+    buffer = tmp.data();
+    result = -std::move(tmp) * 2;
+    EXPECT_EQ(result.data(), buffer);
+    EXPECT_EQ(result, A * -2);
+}
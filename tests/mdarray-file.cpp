@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "gn.h"
+#include "mdarray-file.h"
+
+namespace {
+
+std::string temp_path(const char* name) {
+    return ::testing::TempDir() + name;
+}
+
+} // namespace
+
+TEST(MdarrayFileTest, SaveLoadRoundTrip) {
+    const auto path = temp_path("eccpp-gn.mda");
+    const auto g = eccpp::gn(16);
+    eccpp::save_mdarray(path, g);
+
+    EXPECT_EQ(eccpp::load_mdarray<int>(path), g);
+
+    const eccpp::mapped_mdarray<int> mapped(path);
+    EXPECT_EQ(mapped.dimensions(), g.dimensions());
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(mapped.data()) % 64, 0);
+    EXPECT_EQ(mapped.to_mdarray(), g);
+    EXPECT_EQ(mapped.view()({15, 3}), 1);
+    EXPECT_EQ(eccpp::mdarray<int>(mapped.view().transpose()), g.view().transpose().to_mdarray());
+
+    // moving keeps the mapping alive
+    eccpp::mapped_mdarray<int> moved = eccpp::mapped_mdarray<int>(path);
+    moved = eccpp::mapped_mdarray<int>(path);
+    EXPECT_EQ(moved.to_mdarray(), g);
+
+    std::remove(path.c_str());
+}
+
+TEST(MdarrayFileTest, HigherRankAndFloat) {
+    const auto path = temp_path("eccpp-3d.mda");
+    eccpp::mdarray<double> a({3, 1, 7});
+    for (size_t i = 0; i < a.size(); ++i)
+        a.data()[i] = double(i) / 3.0;
+
+    eccpp::save_mdarray(path, a);
+    EXPECT_EQ(eccpp::load_mdarray<double>(path), a);
+    EXPECT_EQ(eccpp::mapped_mdarray<double>(path).to_mdarray(), a);
+
+    // the element type is part of the format
+    EXPECT_THROW(eccpp::load_mdarray<float>(path), std::runtime_error);
+    EXPECT_THROW(eccpp::mapped_mdarray<std::int64_t>{path}, std::runtime_error);
+
+    std::remove(path.c_str());
+}
+
+TEST(MdarrayFileTest, CorruptFilesThrow) {
+    const auto path = temp_path("eccpp-bad.mda");
+    eccpp::mdarray<int> a({4, 4});
+    eccpp::save_mdarray(path, a);
+
+    std::string contents;
+    {
+        std::ifstream in(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in), {});
+    }
+
+    auto write = [&](const std::string& data) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(data.data(), std::streamsize(data.size()));
+    };
+
+    write(contents.substr(0, contents.size() - 1));
+    EXPECT_THROW(eccpp::load_mdarray<int>(path), std::runtime_error);
+    EXPECT_THROW(eccpp::mapped_mdarray<int>{path}, std::runtime_error);
+
+    auto bad_magic = contents;
+    bad_magic[0] = 'X';
+    write(bad_magic);
+    EXPECT_THROW(eccpp::mapped_mdarray<int>{path}, std::runtime_error);
+
+    auto bad_version = contents;
+    bad_version[8] = 2;
+    write(bad_version);
+    EXPECT_THROW(eccpp::load_mdarray<int>(path), std::runtime_error);
+
+    // same size, different type
+    write(contents);
+    EXPECT_THROW(eccpp::load_mdarray<float>(path), std::runtime_error);
+    EXPECT_THROW(eccpp::mapped_mdarray<unsigned>{path}, std::runtime_error);
+
+    eccpp::save_mdarray(path, eccpp::mdarray<std::uint8_t>({4, 4}));
+    EXPECT_THROW(eccpp::mapped_mdarray<char>{path}, std::runtime_error);
+    EXPECT_THROW(eccpp::mapped_mdarray<std::int8_t>{path}, std::runtime_error);
+    EXPECT_NO_THROW(eccpp::mapped_mdarray<std::uint8_t>{path});
+
+    write("");
+    EXPECT_THROW(eccpp::mapped_mdarray<int>{path}, std::runtime_error);
+
+    std::remove(path.c_str());
+    EXPECT_THROW(eccpp::mapped_mdarray<int>{path}, std::runtime_error);
+    EXPECT_THROW(eccpp::load_mdarray<int>(path), std::runtime_error);
+}
@@ -152,3 +152,43 @@ TEST_F(MdarrayMulTest, DefaultMulOperator) {
     EXPECT_EQ(A_copy({0, 0, 0, 0}), 38);
     EXPECT_EQ(A_copy({1, 1, 1, 1}), 272);
 }
+
+template <typename T>
+static void checkBlockedMatrixProduct(size_t m, size_t k, size_t n, size_t threads) {
+    eccpp::mdarray<T> A({m, k});
+    eccpp::mdarray<T> B({k, n});
+    for (size_t i = 0; i < m; ++i)
+        for (size_t j = 0; j < k; ++j)
+            A({i, j}) = T((i * 7 + j * 3) % 11) - 5;
+    for (size_t i = 0; i < k; ++i)
+        for (size_t j = 0; j < n; ++j)
+            B({i, j}) = T((i * 5 + j * 13) % 7) - 3;
+
+    // small integer values keep floating point sums exact regardless of summation order
+    eccpp::mdarray<T> expected({m, n});
+    for (size_t i = 0; i < m; ++i)
+        for (size_t j = 0; j < n; ++j) {
+            T sum = 0;
+            for (size_t p = 0; p < k; ++p)
+                sum += A({i, p}) * B({p, j});
+            expected({i, j}) = sum;
+        }
+
+    EXPECT_EQ(A * B, expected) << m << "x" << k << "x" << n;
+    EXPECT_EQ(matmul(A, B, threads), expected) << m << "x" << k << "x" << n;
+}
+
+TEST_F(MdarrayMulTest, BlockedMatrixMultiplication) {
+    // sizes straddling micro-tile and cache block boundaries
+    for (auto [m, k, n]: std::vector<std::tuple<size_t, size_t, size_t>>{{1, 1, 1}, {7, 300, 17}, {150, 257, 33}, {200, 130, 300}}) {
+        checkBlockedMatrixProduct<int>(m, k, n, 1);
+        checkBlockedMatrixProduct<float>(m, k, n, 3);
+        checkBlockedMatrixProduct<double>(m, k, n, 2);
+    }
+
+    eccpp::mdarray<float> A({2, 3});
+    eccpp::mdarray<float> B({2, 3});
+    eccpp::mdarray<float> C({2, 3, 1});
+    EXPECT_THROW(matmul(A, B, 1), std::invalid_argument);
+    EXPECT_THROW(matmul(C, B, 1), std::invalid_argument);
+}
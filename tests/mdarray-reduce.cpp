@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <numeric>
+#include <algorithm>
+
+#include "mdarray.h"
+
+namespace ex = eccpp::execution;
+
+TEST(MdarrayReduceTest, SmallValues) {
+    eccpp::mdarray<int> a({2, 3});
+    const int values[] = {3, -7, 5, 9, -7, 9};
+    std::copy(std::begin(values), std::end(values), a.data());
+
+    EXPECT_EQ(a.sum(), 12);
+    EXPECT_EQ(a.abs_sum(), 40);
+    EXPECT_EQ(a.min(), -7);
+    EXPECT_EQ(a.max(), 9);
+    EXPECT_EQ(a.argmin(), 1);       // first occurrence wins
+    EXPECT_EQ(a.argmax(), 3);
+
+    EXPECT_EQ(a.sum(ex::par), 12);
+    EXPECT_EQ(a.argmax(ex::par_unseq), 3);
+}
+
+TEST(MdarrayReduceTest, ReproducibleAcrossPolicies) {
+    // large enough for several blocks and threads
+    const size_t n = 300001;
+    eccpp::mdarray<float> a({n});
+    std::mt19937 gen(1);
+    std::normal_distribution<float> dist(0.0f, 100.0f);
+    for (size_t i = 0; i < n; ++i)
+        a.data()[i] = dist(gen);
+
+    const float sum = a.sum();
+    const float abs_sum = a.abs_sum();
+    EXPECT_NEAR(sum, std::accumulate(a.data(), a.data() + n, 0.0), 1e-3 * abs_sum);
+
+    for (size_t threads: {1, 2, 3, 7}) {
+        EXPECT_EQ(a.sum(ex::unseq), sum);
+        EXPECT_EQ(a.sum(ex::par(threads)), sum);
+        EXPECT_EQ(a.sum(ex::par_unseq(threads)), sum);
+        EXPECT_EQ(a.abs_sum(ex::par(threads)), abs_sum);
+        EXPECT_EQ(a.argmin(ex::par(threads)), a.argmin());
+        EXPECT_EQ(a.argmax(ex::par_unseq(threads)), a.argmax());
+    }
+
+    EXPECT_EQ(a.max(), *std::max_element(a.data(), a.data() + n));
+    EXPECT_EQ(a.argmin(), size_t(std::min_element(a.data(), a.data() + n) - a.data()));
+}
+
+TEST(MdarrayReduceTest, ElementWisePolicies) {
+    const size_t n = 100000;
+    eccpp::mdarray<double> a({n / 100, 100});
+    eccpp::mdarray<double> b({n / 100, 100});
+    for (size_t i = 0; i < n; ++i) {
+        a.data()[i] = double(i);
+        b.data()[i] = double(n - i);
+    }
+
+    const eccpp::mdarray<double> expected = a + b * 2.0;
+
+    eccpp::mdarray<double> c({1});
+    c.assign(ex::seq, a + b * 2.0);
+    EXPECT_EQ(c, expected);
+
+    eccpp::mdarray<double> d({n / 100, 100});
+    d.assign(ex::par(4), a + b * 2.0);
+    EXPECT_EQ(d, expected);
+
+    d.assign(ex::unseq, a).add(ex::par_unseq(3), b * 2.0);
+    EXPECT_EQ(d, expected);
+
+    d.subtract(ex::par, b * 2.0).multiply(ex::par(2), 4.0).divide(ex::unseq, 2.0);
+    EXPECT_EQ(d, a * 2.0);
+
+    EXPECT_THROW(d.add(ex::par, eccpp::mdarray<double>({3})), std::invalid_argument);
+}
+
+TEST(MdarrayReduceTest, AssignReshapedFromOwnView) {
+    // the new dimensions come from a view of the array being assigned to
+    eccpp::mdarray<int> b({2, 3}, std::vector<int>{1, 2, 3, 4, 5, 6});
+    b.assign(ex::seq, b.view().transpose());
+    EXPECT_EQ(b, eccpp::mdarray<int>({3, 2}, std::vector<int>{1, 4, 2, 5, 3, 6}));
+
+    b.assign(ex::par(2), b.view().transpose() * 2);
+    EXPECT_EQ(b, eccpp::mdarray<int>({2, 3}, std::vector<int>{2, 4, 6, 8, 10, 12}));
+}
+
+TEST(MdarrayReduceTest, ExtremaOfReleasedArrayThrow) {
+    eccpp::mdarray<int> a({2, 2}, std::vector<int>{3, 1, 4, 1});
+    EXPECT_EQ(a.min(), 1);
+    EXPECT_EQ(a.argmax(ex::par(2)), 2);
+
+    const auto data = std::move(a).release();
+    EXPECT_EQ(data.size(), 4);
+    EXPECT_THROW(a.min(), std::invalid_argument);
+    EXPECT_THROW(a.max(ex::par(2)), std::invalid_argument);
+    EXPECT_THROW(a.argmin(), std::invalid_argument);
+}
@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include "mdarray.h"
+#include "hamdist.h"
+#include "hamweight.h"
+#include "phi.h"
+
+namespace {
+
+eccpp::mdarray<int> createMatrix3x4() {
+    eccpp::mdarray<int> A({3, 4});
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            A({i, j}) = int(i * 10 + j);
+
+    return A;
+}
+
+} // namespace
+
+TEST(MdarrayViewTest, SliceAndSubrange) {
+    auto A = createMatrix3x4();
+    const auto v = A.view();
+    EXPECT_TRUE(v.is_contiguous());
+    EXPECT_EQ(v({2, 3}), 23);
+
+    // row 1
+    const auto row = v.slice(0, 1);
+    ASSERT_EQ(row.dimensions(), std::vector<size_t>({4}));
+    EXPECT_TRUE(row.is_contiguous());
+    EXPECT_EQ(row({2}), 12);
+
+    // column 2
+    const auto col = v.slice(1, 2);
+    ASSERT_EQ(col.dimensions(), std::vector<size_t>({3}));
+    EXPECT_FALSE(col.is_contiguous());
+    EXPECT_EQ(col({0}), 2);
+    EXPECT_EQ(col({2}), 22);
+
+    // 2x2 block starting at (1, 1)
+    const auto block = v.subrange(0, 1, 3).subrange(1, 1, 3);
+    ASSERT_EQ(block.dimensions(), std::vector<size_t>({2, 2}));
+    EXPECT_EQ(block({0, 0}), 11);
+    EXPECT_EQ(block({1, 1}), 22);
+
+    // writes go through to the owner
+    block({1, 0}) = -1;
+    EXPECT_EQ(A({2, 1}), -1);
+
+    EXPECT_THROW(v.slice(2, 0), std::invalid_argument);
+    EXPECT_THROW(v.slice(0, 3), std::invalid_argument);
+    EXPECT_THROW(v.subrange(1, 2, 2), std::invalid_argument);
+    EXPECT_THROW(row.slice(0, 0), std::invalid_argument);
+}
+
+TEST(MdarrayViewTest, TransposeAndReshape) {
+    const auto A = createMatrix3x4();
+    const auto t = A.view().transpose();
+    ASSERT_EQ(t.dimensions(), std::vector<size_t>({4, 3}));
+    for (size_t i = 0; i < 3; ++i)
+        for (size_t j = 0; j < 4; ++j)
+            EXPECT_EQ(t({j, i}), A({i, j}));
+
+    // materialising a transposed view gives a row-major copy
+    const auto tm = t.to_mdarray();
+    EXPECT_EQ(tm({3, 2}), 23);
+    EXPECT_EQ(tm.data()[1], 10);
+
+    eccpp::mdarray<int> T3({2, 3, 4});
+    for (size_t i = 0; i < T3.size(); ++i)
+        T3.data()[i] = int(i);
+    const auto p = T3.view().permute({2, 0, 1});
+    ASSERT_EQ(p.dimensions(), std::vector<size_t>({4, 2, 3}));
+    EXPECT_EQ(p({3, 1, 2}), T3({1, 2, 3}));
+
+    const auto r = A.view().reshape({2, 6});
+    EXPECT_EQ(r({1, 0}), A({1, 2}));
+
+    EXPECT_THROW(t.reshape({12}), std::invalid_argument);
+    EXPECT_THROW(A.view().reshape({5, 2}), std::invalid_argument);
+    EXPECT_THROW(T3.view().permute({0, 0, 1}), std::invalid_argument);
+}
+
+TEST(MdarrayViewTest, Arithmetic) {
+    auto A = createMatrix3x4();
+    const auto B = createMatrix3x4();
+
+    // A^T's first two rows + A's first two columns transposed = 2 * A's first two columns
+    const auto left = A.view().subrange(1, 0, 2);
+    eccpp::mdarray<int> sum = left.transpose() + B.view().subrange(1, 0, 2).transpose();
+    ASSERT_EQ(sum.dimensions(), std::vector<size_t>({2, 3}));
+    for (size_t i = 0; i < 2; ++i)
+        for (size_t j = 0; j < 3; ++j)
+            EXPECT_EQ(sum({i, j}), 2 * A({j, i}));
+
+    // mixing owning arrays and views
+    eccpp::mdarray<int> diff = A - B.view() * 2;
+    EXPECT_EQ(diff, -A);
+
+    // assignment into a strided sub-block
+    A.view().slice(1, 3).assign(B.view().slice(1, 0) * 100);
+    for (size_t i = 0; i < 3; ++i)
+        EXPECT_EQ(A({i, 3}), B({i, 0}) * 100);
+
+    // contraction with a transposed view
+    const auto AtA = B.view().transpose() * B;
+    EXPECT_EQ(AtA.dimensions(), std::vector<size_t>({4, 4}));
+    EXPECT_EQ(AtA({1, 2}), 1 * 2 + 11 * 12 + 21 * 22);
+}
+
+TEST(MdarrayViewTest, AssignFromOverlappingView) {
+    eccpp::mdarray<int> A({3, 3}, std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9});
+    const auto original = A;
+    const eccpp::mdarray<int> transposed({3, 3}, std::vector<int>{1, 4, 7, 2, 5, 8, 3, 6, 9});
+
+    A = A.view().transpose();
+    EXPECT_EQ(A, transposed);
+
+    A = original;
+    A += A.view().transpose();
+    EXPECT_EQ(A, original + transposed);
+
+    A = original;
+    A -= A.view().transpose() * 2;
+    EXPECT_EQ(A, original - transposed * 2);
+
+    // the same layout is still evaluated in place
+    A = original;
+    A = A.view() + A;
+    EXPECT_EQ(A, original * 2);
+
+    // a view writing into a shifted copy of itself
+    A = original;
+    A.view().subrange(1, 1, 3).assign(A.view().subrange(1, 0, 2));
+    EXPECT_EQ(A, eccpp::mdarray<int>({3, 3}, std::vector<int>{1, 1, 2, 4, 4, 5, 7, 7, 8}));
+
+    A = original;
+    A.view().transpose().assign(A);
+    EXPECT_EQ(A, transposed);
+}
+
+TEST(MdarrayViewTest, HamdistHamweightPhi) {
+    eccpp::mdarray<int> bits({2, 4});
+    const int values[] = {1, 0, 1, 1, 0, 0, 1, 0};
+    std::copy(values, values + 8, bits.data());
+
+    EXPECT_EQ(eccpp::hamweight(bits.view().slice(0, 0)), 3);
+    EXPECT_EQ(eccpp::hamweight(bits.view().slice(1, 2)), 2);
+    EXPECT_EQ(eccpp::hamdist(bits.view().slice(0, 0), bits.view().slice(0, 1)), 2);
+    EXPECT_EQ(eccpp::hamdist(bits, bits.view()), 0);
+    EXPECT_EQ(eccpp::hamdist(bits.view().transpose(), bits.view().reshape({4, 2})), 4);
+
+    eccpp::mdarray<double> pm({2, 3}), llr({2, 3});
+    for (size_t i = 0; i < 6; ++i) {
+        pm.data()[i] = double(i);
+        llr.data()[i] = i % 2 ? -1.0 : 2.0;
+    }
+
+    const auto full = eccpp::phi(pm, llr, 1.0, true);
+    const auto row = eccpp::phi(pm.view().slice(0, 1), llr.view().slice(0, 1), 1.0, true);
+    for (size_t j = 0; j < 3; ++j)
+        EXPECT_EQ(row({j}), full({1, j}));
+}
+
+TEST(MdarrayViewTest, FlatAndStridedKernelsAgree) {
+    // at.view().transpose() has the same elements as a but goes through the strided path
+    eccpp::mdarray<int> a({3, 4, 5}), b({3, 4, 5});
+    eccpp::mdarray<double> pm({3, 4, 5}), llr({3, 4, 5});
+    for (size_t i = 0; i < a.size(); ++i) {
+        a.data()[i] = int((i * 7) % 3 == 0);
+        b.data()[i] = int((i * 5) % 4 == 1);
+        pm.data()[i] = double(i % 9);
+        llr.data()[i] = double(int(i % 11) - 5);   // includes zeros
+    }
+    llr.data()[17] = std::numeric_limits<double>::quiet_NaN();
+
+    const auto at = a.view().transpose().to_mdarray();
+    const auto bt = b.view().transpose().to_mdarray();
+    const auto llrt = llr.view().transpose().to_mdarray();
+    EXPECT_FALSE(at.view().transpose().is_contiguous());
+
+    EXPECT_EQ(eccpp::hamweight(a), eccpp::hamweight(at.view().transpose()));
+    EXPECT_EQ(eccpp::hamdist(a, b), eccpp::hamdist(at.view().transpose(), bt.view().transpose()));
+
+    for (double u: {0.0, 1.0}) {
+        for (bool approx: {true, false}) {
+            const auto flat = eccpp::phi(pm, llr, u, approx);
+            const auto strided = eccpp::phi(pm, llrt.view().transpose(), u, approx);
+            for (size_t i = 0; i < flat.size(); ++i) {
+                if (std::isnan(strided.data()[i]))
+                    EXPECT_TRUE(std::isnan(flat.data()[i]));
+                else
+                    EXPECT_EQ(flat.data()[i], strided.data()[i]);
+            }
+        }
+    }
+
+    EXPECT_EQ(a.span().size(), a.size());
+    EXPECT_EQ(a.view().slice(0, 1).span().data(), a.data() + 20);
+    EXPECT_THROW(at.view().transpose().span(), std::invalid_argument);
+}
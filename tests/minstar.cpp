@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <cmath>
+#include <cstring>
 #include <limits>
 
 #include "minstar.h"
@@ -84,3 +85,170 @@ TEST_F(MinStarTest, EdgeCases) {
     EXPECT_TRUE(std::isnan(eccpp::minstar(nan_val, 1.0, true)));
     EXPECT_TRUE(std::isnan(eccpp::minstar(1.0, nan_val, true)));
 }
+
+namespace {
+
+std::vector<double> test_values() {
+    const double inf = std::numeric_limits<double>::infinity();
+    std::vector<double> values = {0.0, -0.0, inf, -inf, 1e-3, -1e-3, 30.0, -30.0};
+    for (int i = -40; i <= 40; ++i)
+        values.push_back(i * 0.37);
+    return values;
+}
+
+}
+
+TEST_F(MinStarTest, BatchedMatchesScalar) {
+    const auto values = test_values();
+    std::vector<double> a, b;
+    for (auto x: values)
+        for (auto y: values) {
+            a.push_back(x);
+            b.push_back(y);
+        }
+
+    std::vector<double> exact(a.size()), lut(a.size()), offset(a.size()), normalized(a.size());
+    eccpp::minstar<double>(a, b, exact, {eccpp::minstar_mode::exact});
+    eccpp::minstar<double>(a, b, lut, {eccpp::minstar_mode::jacobian_lut});
+    eccpp::minstar<double>(a, b, offset, {eccpp::minstar_mode::offset_min_sum, 0.0});
+    eccpp::minstar<double>(a, b, normalized, {eccpp::minstar_mode::normalized_min_sum, 0.0, 1.0});
+
+    for (size_t i = 0; i < a.size(); ++i) {
+        // the scalar atanh formula loses digits once tanh() gets close to 1, so the reference
+        // uses long double
+        const double expected = std::isinf(a[i]) || std::isinf(b[i]) ? eccpp::minstar(a[i], b[i], false) :
+            double(2 * std::atanh(std::tanh((long double)a[i] / 2) * std::tanh((long double)b[i] / 2)));
+        if (std::isinf(expected)) {
+            EXPECT_EQ(exact[i], expected);
+            EXPECT_EQ(lut[i], expected);
+        }
+        else {
+            EXPECT_NEAR(exact[i], expected, 1e-6) << a[i] << " " << b[i];
+            EXPECT_NEAR(lut[i], exact[i], 0.13) << a[i] << " " << b[i];
+        }
+        EXPECT_EQ(offset[i], eccpp::minstar(a[i], b[i], true));
+        EXPECT_EQ(normalized[i], eccpp::minstar(a[i], b[i], true));
+
+        // MATLAB sign(): a zero on either side gives zero whatever the mode
+        if (a[i] == 0 || b[i] == 0) {
+            EXPECT_EQ(exact[i], 0.0);
+            EXPECT_EQ(lut[i], 0.0);
+        }
+    }
+}
+
+TEST_F(MinStarTest, BatchedModes) {
+    const std::vector<float> a = {3.0f, -3.0f, 0.25f, 2.0f, NAN};
+    const std::vector<float> b = {2.0f, 5.0f, -1.0f, 0.0f, 1.0f};
+    std::vector<float> out(a.size());
+
+    eccpp::minstar<float>(a, b, out, {eccpp::minstar_mode::offset_min_sum, 0.5f});
+    EXPECT_EQ(out[0], 1.5f);
+    EXPECT_EQ(out[1], -2.5f);
+    EXPECT_EQ(out[2], -0.0f);
+    EXPECT_EQ(out[3], 0.0f);
+    EXPECT_TRUE(std::isnan(out[4]));
+
+    eccpp::minstar<float>(a, b, out, {eccpp::minstar_mode::normalized_min_sum, 0.0f, 0.75f});
+    EXPECT_EQ(out[0], 1.5f);
+    EXPECT_EQ(out[1], -2.25f);
+    EXPECT_EQ(out[2], -0.1875f);
+    EXPECT_EQ(out[3], 0.0f);
+    EXPECT_TRUE(std::isnan(out[4]));
+
+    // in place
+    std::vector<float> c = a;
+    eccpp::minstar<float>(c, b, c, {eccpp::minstar_mode::jacobian_lut});
+    EXPECT_TRUE(std::isnan(c[4]));
+    EXPECT_NEAR(c[0], eccpp::minstar(3.0f, 2.0f, false), 0.13f);
+
+    EXPECT_THROW(eccpp::minstar<float>(a, std::vector<float>(2), out), std::invalid_argument);
+}
+
+TEST_F(MinStarTest, KernelsAgree) {
+    using eccpp::detail::minstar_isa;
+    const auto values = test_values();
+    std::vector<float> a(1000), b(1000);
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = float(values[i % values.size()]);
+        b[i] = float(values[i * 7 % values.size()]);
+    }
+    a[500] = NAN;
+
+    EXPECT_TRUE(eccpp::detail::minstar_isa_supported(minstar_isa::generic));
+    EXPECT_TRUE(eccpp::detail::minstar_isa_supported(eccpp::detail::minstar_best_isa()));
+
+    // every kernel the CPU can run gives bit-identical results, tails and chunk ends included
+    auto check = [&]<eccpp::minstar_mode Mode>() {
+        const auto generic = eccpp::detail::minstar_pairwise_kernel<Mode, float>(minstar_isa::generic);
+        for (auto isa: {minstar_isa::avx2, minstar_isa::avx512}) {
+            if (!eccpp::detail::minstar_isa_supported(isa))
+                continue;
+
+            const auto kernel = eccpp::detail::minstar_pairwise_kernel<Mode, float>(isa);
+            for (size_t n: {0, 1, 7, 17, 255, 256, 257, 1000}) {
+                std::vector<float> expected(n), result(n);
+                generic(a.data(), b.data(), expected.data(), n, 0.5f, 0.75f);
+                kernel(a.data(), b.data(), result.data(), n, 0.5f, 0.75f);
+                EXPECT_EQ(std::memcmp(result.data(), expected.data(), n * sizeof(float)), 0) << int(isa) << " " << n;
+            }
+        }
+    };
+    check.operator()<eccpp::minstar_mode::jacobian_lut>();
+    check.operator()<eccpp::minstar_mode::offset_min_sum>();
+    check.operator()<eccpp::minstar_mode::normalized_min_sum>();
+}
+
+TEST_F(MinStarTest, ExtrinsicMatchesLeaveOneOut) {
+    const std::vector<std::vector<double>> rows = {
+        {1.5, -0.5, 2.0, 3.5, -4.0, 0.75, 6.0, -1.25},
+        {2.0, 0.0, -3.0, 1.0},
+        {2.0, 0.0, -3.0, 0.0},
+        {-1.0, 4.0},
+        {1.0, NAN, -2.0, 3.0},
+    };
+
+    for (const auto& row: rows) {
+        for (auto mode: {eccpp::minstar_mode::exact, eccpp::minstar_mode::jacobian_lut,
+                         eccpp::minstar_mode::offset_min_sum, eccpp::minstar_mode::normalized_min_sum}) {
+            const eccpp::minstar_config<double> config{mode, 0.25, 0.75};
+            std::vector<double> out(row.size());
+            eccpp::minstar_extrinsic<double>(row, out, config);
+
+            for (size_t i = 0; i < row.size(); ++i) {
+                // reference: exact fold over the others, the min-sum modes only keep the min
+                double sign = 1;
+                double min = std::numeric_limits<double>::infinity();
+                double fold = std::numeric_limits<double>::quiet_NaN();
+                bool first = true;
+                for (size_t j = 0; j < row.size(); ++j) {
+                    if (j == i)
+                        continue;
+                    sign *= eccpp::sign(row[j]);
+                    min = std::min(min, std::abs(row[j]));
+                    fold = first ? row[j] : eccpp::minstar(fold, row[j], false);
+                    first = false;
+                    if (std::isnan(row[j]))
+                        min = row[j];
+                }
+
+                double expected;
+                if (mode == eccpp::minstar_mode::offset_min_sum)
+                    expected = sign * std::max(min - 0.25, 0.0);
+                else if (mode == eccpp::minstar_mode::normalized_min_sum)
+                    expected = sign * 0.75 * min;
+                else
+                    expected = fold;
+
+                if (std::isnan(expected))
+                    EXPECT_TRUE(std::isnan(out[i]));
+                else
+                    EXPECT_NEAR(out[i], expected, mode == eccpp::minstar_mode::jacobian_lut ? 0.3 : 1e-9);
+            }
+        }
+    }
+
+    std::vector<double> single = {2.0};
+    eccpp::minstar_extrinsic<double>(single, single);
+    EXPECT_TRUE(std::isnan(single[0]));
+}
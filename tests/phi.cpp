@@ -122,3 +122,71 @@ TEST(PhiTest, Polar5GTest2) {
     // Verify equality
     EXPECT_EQ(result, expected);
 }
+
+TEST(PhiTest, ExactIsStableForLargeLlr) {
+    eccpp::mdarray<float> PM({3}, std::vector<float>{1, 2, 3});
+    eccpp::mdarray<float> L({3}, std::vector<float>{1000, -1000, 200});
+
+    // log(1 + exp(1000)) overflows when computed directly
+    auto result = eccpp::phi(PM, L, 1.0f, false);
+    EXPECT_FLOAT_EQ(result({0}), 1001.0f);
+    EXPECT_FLOAT_EQ(result({1}), 2.0f);
+    EXPECT_FLOAT_EQ(result({2}), 203.0f);
+
+    eccpp::phi_inplace(PM, L, 0.0f, eccpp::phi_mode::exact);
+    EXPECT_FLOAT_EQ(PM({0}), 1.0f);
+    EXPECT_FLOAT_EQ(PM({1}), 1002.0f);
+    EXPECT_FLOAT_EQ(PM({2}), 3.0f);
+}
+
+TEST(PhiTest, InplaceMatchesPhiPerPath) {
+    const size_t paths = 4;
+    const size_t elements = 37;
+
+    eccpp::mdarray<double> PM({paths, elements}), L({paths, elements});
+    for (size_t i = 0; i < PM.size(); ++i) {
+        PM.data()[i] = double(i % 7);
+        L.data()[i] = double(int(i * 37 % 61) - 30) / 3.0;
+    }
+    L.data()[5] = 0;
+    const std::vector<double> u = {0, 1, 1, 0};
+
+    for (auto mode: {eccpp::phi_mode::exact, eccpp::phi_mode::fast, eccpp::phi_mode::approx_minstar}) {
+        auto result = PM;
+        eccpp::phi_inplace(result, L, std::span<const double>(u), mode);
+
+        for (size_t l = 0; l < paths; ++l) {
+            const auto row = eccpp::phi(PM.view().slice(0, l), L.view().slice(0, l), u[l], mode == eccpp::phi_mode::approx_minstar);
+            for (size_t m = 0; m < elements; ++m) {
+                if (mode == eccpp::phi_mode::fast)
+                    EXPECT_NEAR(result({l, m}), row({m}), 6e-4);
+                else
+                    EXPECT_DOUBLE_EQ(result({l, m}), row({m}));
+            }
+        }
+    }
+
+    EXPECT_THROW(eccpp::phi_inplace(PM, L, std::span<const double>(u.data(), 3), eccpp::phi_mode::fast), std::invalid_argument);
+}
+
+TEST(PhiTest, InplaceStridedView) {
+    eccpp::mdarray<float> PM({3, 2}), L({2, 3});
+    for (size_t i = 0; i < 6; ++i)
+        L.data()[i] = float(i) - 2.5f;
+
+    eccpp::phi_inplace(PM, L.view().transpose(), 1.0f, eccpp::phi_mode::approx_minstar);
+    EXPECT_EQ(PM, eccpp::phi(eccpp::mdarray<float>({3, 2}), L.view().transpose().to_mdarray(), 1.0f, true));
+}
+
+TEST(PhiTest, FastModeAccuracy) {
+    double worst = 0;
+    for (int i = -40000; i <= 40000; ++i) {
+        const double L = i / 1000.0;
+        double pm_fast = 0, pm_exact = 0;
+        const double u = 1;
+        eccpp::phi_inplace(&pm_fast, &L, &u, 1, 1, eccpp::phi_mode::fast);
+        eccpp::phi_inplace(&pm_exact, &L, &u, 1, 1, eccpp::phi_mode::exact);
+        worst = std::max(worst, std::abs(pm_fast - pm_exact));
+    }
+    EXPECT_LT(worst, 6e-4);
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 #include <random>
+#include <algorithm>
+#include <bit>
 
 #include "polar-dec.h"
 
@@ -123,3 +125,123 @@ TEST(PolarDecTest, Confidence) {
         EXPECT_LT(result_noisy.confidence, result_intact.confidence);
     }
 }
+
+namespace {
+
+// the k most reliable positions for polar_enc_butterfly: the most ones in the index first, i.e.
+// the heaviest rows of G_n (see examples/frozen-bits.cpp)
+std::vector<size_t> reliable_bits(size_t n, size_t k) {
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i)
+        order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [](size_t a, size_t b) {
+        return std::popcount(a) > std::popcount(b);
+    });
+    order.resize(k);
+    std::sort(order.begin(), order.end());
+    return order;
+}
+
+std::vector<int> with_frozen_bits(size_t n, const std::vector<int>& msg, const std::vector<size_t>& info_bits) {
+    std::vector<int> u(n);
+    for (size_t i = 0; i < info_bits.size(); ++i)
+        u[info_bits[i]] = msg[i];
+    return u;
+}
+
+}
+
+TEST(PolarDecBpTest, ThrowOnWrongInput) {
+    EXPECT_THROW(eccpp::polar_dec_bp<T>(0), std::invalid_argument);
+    EXPECT_THROW(eccpp::polar_dec_bp<T>(1), std::invalid_argument);
+    EXPECT_THROW(eccpp::polar_dec_bp<T>(12), std::invalid_argument);
+
+    eccpp::polar_dec_bp<T> dec(4);
+    EXPECT_THROW(dec.decode(bits_to_llr({1, 0, 1}), {0, 1}), std::invalid_argument);
+    EXPECT_THROW(dec.decode(bits_to_llr({0, 0, 0, 0}), {}), std::invalid_argument);
+    EXPECT_THROW(dec.decode(bits_to_llr({0, 0, 0, 0}), {0, 1, 2, 3, 4}), std::invalid_argument);
+    EXPECT_THROW(dec.decode(bits_to_llr({0, 0, 0, 0}), {1, 4}), std::invalid_argument);
+}
+
+TEST(PolarDecBpTest, ErasuresAndFlips) {
+    const size_t n = 64;
+    const std::uint_fast32_t seed = 12345;
+    eccpp::polar_enc_butterfly enc(n, seed);
+    const auto info_bits = reliable_bits(n, 16);
+    std::minstd_rand rg(7);
+
+    for (auto schedule: {eccpp::polar_bp_schedule::round_trip, eccpp::polar_bp_schedule::flooding}) {
+        eccpp::polar_dec_bp<T> dec(n, seed, 50, schedule);
+        for (int iter = 0; iter < 20; ++iter) {
+            std::vector<int> msg(info_bits.size());
+            for (auto& b: msg)
+                b = rg() & 1;
+            const auto cw = enc.encode(with_frozen_bits(n, msg, info_bits));
+
+            // a clean codeword takes a single round trip, flooding needs log2(n) iterations to get
+            // from the channel to u
+            auto llr = bits_to_llr(cw);
+            auto result = dec.decode(llr, info_bits);
+            EXPECT_TRUE(result.success);
+            EXPECT_EQ(result.iterations, schedule == eccpp::polar_bp_schedule::round_trip ? 1u : 6u);
+            EXPECT_EQ(result.msg, msg);
+            EXPECT_EQ(result.codeword, cw);
+
+            // a quarter of the bits erased, and a flipped one
+            for (auto& v: llr)
+                if ((rg() & 3) == 0)
+                    v = 0;
+            llr[rg() % n] *= -0.5f;
+            result = dec.decode(llr, info_bits);
+            EXPECT_TRUE(result.success);
+            EXPECT_EQ(result.msg, msg);
+            EXPECT_EQ(result.codeword, cw);
+        }
+    }
+}
+
+TEST(PolarDecBpTest, DecodeAwgn) {
+    const size_t n = 256;
+    eccpp::polar_enc_butterfly enc(n);
+    const auto info_bits = reliable_bits(n, 64);
+    std::mt19937 rng(11);
+
+    // rate 1/4 at Eb/N0 = 4 dB
+    const float sigma = 0.892f;
+    std::normal_distribution<float> noise(0.0f, sigma);
+
+    for (auto schedule: {eccpp::polar_bp_schedule::round_trip, eccpp::polar_bp_schedule::flooding})
+        for (auto mode: {eccpp::minstar_mode::exact, eccpp::minstar_mode::jacobian_lut,
+                         eccpp::minstar_mode::offset_min_sum, eccpp::minstar_mode::normalized_min_sum}) {
+            eccpp::polar_dec_bp<T> dec(n, 0, 100, schedule, {mode, 0.25f, 0.9375f});
+            for (int iter = 0; iter < 10; ++iter) {
+                std::vector<int> msg(info_bits.size());
+                for (auto& b: msg)
+                    b = int(rng() & 1);
+                const auto cw = enc.encode(with_frozen_bits(n, msg, info_bits));
+
+                std::vector<T> llr(n);
+                for (size_t i = 0; i < n; ++i)
+                    llr[i] = 2 * ((cw[i] ? -1.0f : 1.0f) + noise(rng)) / (sigma * sigma);
+
+                const auto result = dec.decode(llr, info_bits);
+                EXPECT_TRUE(result.success);
+                EXPECT_EQ(result.msg, msg);
+            }
+        }
+}
+
+TEST(PolarDecBpTest, NoEarlyStopOnNoise) {
+    const size_t n = 128;
+    eccpp::polar_dec_bp<T> dec(n, 0, 30);
+    std::mt19937 rng(5);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+
+    std::vector<T> llr(n);
+    for (auto& v: llr)
+        v = noise(rng);
+
+    const auto result = dec.decode(llr, reliable_bits(n, 8));
+    EXPECT_FALSE(result.success);
+    EXPECT_EQ(result.iterations, 30u);
+}
@@ -70,3 +70,19 @@ TEST(PolarEncTest, GnMatchesButterfly) {
     EXPECT_EQ(data, enc_bfly.encode(enc.encode(data)));
     EXPECT_EQ(data, enc.encode(enc_bfly.encode(data)));
 }
+
+TEST(PolarEncTest, SparseMatchesButterfly) {
+    for (std::uint_fast32_t seed: {0, 7}) {
+        eccpp::polar_enc_sparse enc(4096, seed);
+        eccpp::polar_enc_butterfly enc_bfly(4096, seed);
+
+        std::vector<int> data(4096);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = int((i * 2654435761u) >> 13) & 1;
+
+        EXPECT_EQ(enc.encode(data), enc_bfly.encode(data));
+        EXPECT_EQ(enc.encode(eccpp::execution::par(3), data), enc_bfly.encode(data));
+    }
+
+    EXPECT_THROW(eccpp::polar_enc_sparse(8).encode(std::vector<int>(4)), std::invalid_argument);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <random>
+
+#include "polar-dec.h"
+
+namespace {
+
+std::vector<int> random_bits(size_t n, std::mt19937& rng) {
+    std::vector<int> bits(n);
+    for (auto& b: bits)
+        b = int(rng() & 1);
+    return bits;
+}
+
+}
+
+TEST(PolarKernelTest, ThrowOnBadKernel) {
+    EXPECT_THROW(eccpp::polar_kernel(eccpp::mdarray<int>({2, 3})), std::invalid_argument);
+    EXPECT_THROW(eccpp::polar_kernel(eccpp::mdarray<int>({2, 2}, std::vector<int>{1, 0, 2, 1})), std::invalid_argument);
+    EXPECT_THROW(eccpp::polar_kernel(eccpp::mdarray<int>({2, 2}, std::vector<int>{1, 1, 1, 1})), std::invalid_argument);
+    EXPECT_THROW(eccpp::polar_kernels(0), std::invalid_argument);
+    EXPECT_THROW(eccpp::polar_kernels(10), std::invalid_argument);
+
+    EXPECT_TRUE(eccpp::polar_kernel::arikan().lower_unit_triangular());
+    EXPECT_FALSE(eccpp::polar_kernel::ternary().lower_unit_triangular());
+    EXPECT_EQ(eccpp::polar_kernels(72).size(), 5u);
+    EXPECT_EQ(eccpp::polar_length(eccpp::polar_kernels(72)), 72u);
+}
+
+TEST(PolarKernelTest, ArikanMatchesGn) {
+    for (size_t n = 2; n <= 256; n *= 2)
+        EXPECT_EQ(eccpp::kernel_gn(eccpp::polar_kernels(n)), eccpp::gn(n));
+}
+
+TEST(PolarKernelTest, ArikanMatchesButterfly) {
+    std::mt19937 rng(42);
+    for (size_t n = 1; n <= 4096; n *= 2) {
+        for (std::uint_fast32_t seed: {0, 7}) {
+            eccpp::polar_enc_butterfly butterfly(n, seed);
+            eccpp::polar_enc_kernel enc(n, seed);
+
+            for (int i = 0; i < 4; ++i) {
+                const auto data = random_bits(n, rng);
+                EXPECT_EQ(enc.encode(data), butterfly.encode(data));
+            }
+        }
+    }
+}
+
+TEST(PolarKernelTest, MixedKernelsMatchGenerator) {
+    std::mt19937 rng(1);
+
+    // a non-triangular 4x4 kernel as well, to cover chains with different sizes and both paths
+    const eccpp::polar_kernel k4(eccpp::mdarray<int>({4, 4}, std::vector<int>{1, 0, 1, 0, 1, 1, 0, 0, 0, 1, 1, 1, 1, 0, 0, 1}));
+    const std::vector<std::vector<eccpp::polar_kernel>> chains = {
+        eccpp::polar_kernels(3),
+        eccpp::polar_kernels(9),
+        eccpp::polar_kernels(27),
+        eccpp::polar_kernels(12),
+        eccpp::polar_kernels(18),
+        eccpp::polar_kernels(72),
+        {eccpp::polar_kernel::ternary(), k4, eccpp::polar_kernel::arikan()},
+    };
+
+    for (const auto& kernels: chains) {
+        const auto g = eccpp::kernel_gn(kernels);
+        eccpp::polar_enc_gf2 reference{eccpp::gf2_matrix(g)};
+        eccpp::polar_enc_kernel enc(kernels);
+        const auto view = eccpp::kernel_gn_kron_view(kernels);
+
+        for (int i = 0; i < 8; ++i) {
+            const auto data = random_bits(enc.size(), rng);
+            const auto expected = reference.encode(data);
+            EXPECT_EQ(enc.encode(data), expected);
+            EXPECT_EQ(view.gf2_transpose_multiply(data), expected);
+        }
+    }
+}
+
+TEST(PolarKernelTest, DecodeTernary) {
+    std::mt19937 rng(3);
+    const auto kernels = eccpp::polar_kernels(27);
+    const std::vector<size_t> info_bits = {26, 25, 24, 23, 17, 8};
+
+    for (std::uint_fast32_t seed: {0, 5}) {
+        eccpp::polar_enc_kernel enc(kernels, seed);
+        eccpp::polar_dec<float> dec(kernels, seed);
+
+        for (int i = 0; i < 4; ++i) {
+            const auto msg = random_bits(info_bits.size(), rng);
+            std::vector<int> data(27);
+            for (size_t j = 0; j < info_bits.size(); ++j)
+                data[info_bits[j]] = msg[j];
+
+            const auto cw = enc.encode(data);
+            std::vector<float> llr(cw.size());
+            for (size_t j = 0; j < cw.size(); ++j)
+                llr[j] = cw[j] ? -10.0f : 10.0f;
+            llr[4] = -llr[4];   // one bit error
+
+            EXPECT_EQ(dec.decode(llr, info_bits).msg, msg);
+        }
+    }
+}
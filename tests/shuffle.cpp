@@ -13,3 +13,48 @@ TEST(ShuffleTest, ShuffleUnshuffle) {
         EXPECT_EQ(vec, expected);
     }
 }
+
+TEST(ShuffleTest, PermMatchesShuffle) {
+    for (size_t n: {1, 2, 10, 33, 1000, 70000}) {
+        std::vector<int> vec(n);
+        for (size_t i = 0; i < n; ++i)
+            vec[i] = i;
+
+        std::vector<float> llr(n);
+        for (size_t i = 0; i < n; ++i)
+            llr[i] = i * 0.5f;
+
+        for (auto seed = 1; seed < 20; ++seed) {
+            const eccpp::shuffle_perm perm(n, seed);
+
+            auto expected = vec;
+            eccpp::shuffle(expected, seed);
+            auto result = vec;
+            perm.shuffle(result);
+            EXPECT_EQ(result, expected);
+
+            perm.unshuffle(result);
+            EXPECT_EQ(result, vec);
+
+            auto expected_llr = llr;
+            eccpp::shuffle(expected_llr, seed);
+            std::vector<float> result_llr(n);
+            perm.shuffle(llr, result_llr);
+            EXPECT_EQ(result_llr, expected_llr);
+
+            std::vector<float> back_llr(n);
+            perm.unshuffle(result_llr, back_llr);
+            EXPECT_EQ(back_llr, llr);
+
+            eccpp::unshuffle(expected_llr, seed);
+            EXPECT_EQ(expected_llr, llr);
+        }
+    }
+}
+
+TEST(ShuffleTest, PermSizeMismatchThrows) {
+    const eccpp::shuffle_perm perm(10, 1);
+    std::vector<int> vec(11);
+    EXPECT_THROW(perm.shuffle(vec), std::invalid_argument);
+    EXPECT_THROW(perm.unshuffle(vec), std::invalid_argument);
+}
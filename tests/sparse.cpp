@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <set>
+#include <mutex>
+#include <thread>
+
+#include "sparse.h"
+#include "gn.h"
+
+namespace {
+
+eccpp::mdarray<double> test_matrix() {
+    // 4 x 5 with an empty row and an empty column
+    eccpp::mdarray<double> m({4, 5});
+    m({0, 0}) = 1.5;
+    m({0, 3}) = -2;
+    m({1, 1}) = 4;
+    m({3, 0}) = 0.5;
+    m({3, 1}) = 3;
+    m({3, 3}) = 1;
+    return m;
+}
+
+} // namespace
+
+TEST(SparseTest, ConstructionAndAccess) {
+    const auto dense = test_matrix();
+    const eccpp::csr_matrix<double> csr(dense);
+    const eccpp::csc_matrix<double> csc(dense);
+
+    EXPECT_EQ(csr.rows(), 4);
+    EXPECT_EQ(csr.cols(), 5);
+    EXPECT_EQ(csr.nonzeros(), 6);
+    EXPECT_EQ(csc.nonzeros(), 6);
+    EXPECT_EQ(csr.to_mdarray(), dense);
+    EXPECT_EQ(csc.to_mdarray(), dense);
+    EXPECT_EQ(csr.to_csc(), csc);
+    EXPECT_EQ(csc.to_csr(), csr);
+
+    for (size_t r = 0; r < 4; ++r)
+        for (size_t c = 0; c < 5; ++c) {
+            EXPECT_EQ(csr(r, c), dense({r, c}));
+            EXPECT_EQ(csc(r, c), dense({r, c}));
+        }
+
+    std::vector<size_t> cols;
+    std::vector<double> vals;
+    csr.for_each_in_row(3, [&](size_t c, double v) { cols.push_back(c); vals.push_back(v); });
+    EXPECT_EQ(cols, std::vector<size_t>({0, 1, 3}));
+    EXPECT_EQ(vals, std::vector<double>({0.5, 3, 1}));
+    EXPECT_TRUE(csr.indices(2).empty());
+
+    std::vector<size_t> rows;
+    csc.for_each_in_column(1, [&](size_t r, double) { rows.push_back(r); });
+    EXPECT_EQ(rows, std::vector<size_t>({1, 3}));
+    EXPECT_EQ(csc.values(0).size(), 2);
+
+    EXPECT_THROW(csr(4, 0), std::invalid_argument);
+    EXPECT_THROW(csr.indices(4), std::invalid_argument);
+    EXPECT_THROW(csc.values(5), std::invalid_argument);
+    EXPECT_THROW(eccpp::csr_matrix<double>(eccpp::mdarray<double>({3})), std::invalid_argument);
+    EXPECT_THROW(eccpp::csr_matrix<int>(2, 2, {0, 1, 1}, {2}, {1}), std::invalid_argument);
+    EXPECT_THROW(eccpp::csr_matrix<int>(2, 2, {0, 2, 2}, {1, 0}, {1, 1}), std::invalid_argument);
+    EXPECT_THROW(eccpp::csr_matrix<int>(2, 2, {0, 1}, {0}, {1}), std::invalid_argument);
+}
+
+TEST(SparseTest, RealProducts) {
+    const auto dense = test_matrix();
+    const eccpp::csr_matrix<double> csr(dense);
+    const eccpp::csc_matrix<double> csc(dense);
+
+    const std::vector<double> x = {1, 2, 3, 4, 5};
+    const std::vector<double> expected = {1.5 - 8, 8, 0, 0.5 + 6 + 4};
+    EXPECT_EQ(csr * x, expected);
+    EXPECT_EQ(csc.multiply(x), expected);
+    EXPECT_EQ(csr.multiply(eccpp::execution::par, x), expected);
+
+    const std::vector<double> y = {1, -1, 2, 2};
+    const std::vector<double> expected_t = {1.5 + 1, -4 + 6, 0, -2 + 2, 0};
+    EXPECT_EQ(csr.transpose_multiply(y), expected_t);
+    EXPECT_EQ(csc.transpose_multiply(eccpp::execution::par_unseq, y), expected_t);
+
+    EXPECT_THROW(csr.multiply(y), std::invalid_argument);
+    EXPECT_THROW(csc.transpose_multiply(x), std::invalid_argument);
+}
+
+TEST(SparseTest, Gf2ProductsMatchDense) {
+    // random-ish 300 x 200 matrix, big enough for several words and threads
+    const size_t rows = 300, cols = 200;
+    eccpp::gf2_matrix m(rows, cols);
+    for (size_t r = 0; r < rows; ++r)
+        for (size_t c = 0; c < cols; ++c)
+            if (((r * 131 + c * 71) * 2654435761u >> 20) % 7 == 0)
+                m.set(r, c, 1);
+
+    const eccpp::csr_matrix<std::uint8_t> csr(m);
+    const eccpp::csc_matrix<std::uint8_t> csc(m);
+    EXPECT_EQ(csr.to_csc(), csc);
+    EXPECT_EQ(eccpp::gf2_matrix(csr.to_mdarray()), m);
+
+    std::vector<int> xb(cols), yb(rows);
+    for (size_t i = 0; i < cols; ++i)
+        xb[i] = int(i % 3 == 1);
+    for (size_t i = 0; i < rows; ++i)
+        yb[i] = int(i % 5 < 2);
+
+    const auto x = eccpp::pack_bits(xb);
+    const auto y = eccpp::pack_bits(yb);
+
+    EXPECT_EQ(csr.gf2_multiply(x), m * x);
+    EXPECT_EQ(csc.gf2_multiply(x), m * x);
+    EXPECT_EQ(csr.gf2_multiply(eccpp::execution::par(4), x), m * x);
+
+    EXPECT_EQ(csr.gf2_transpose_multiply(y), y * m);
+    EXPECT_EQ(csc.gf2_transpose_multiply(eccpp::execution::par(4), y), y * m);
+
+    // padding bits of caller-built vectors are ignored
+    auto dirty_x = x;
+    dirty_x.back() |= ~eccpp::packed_tail_mask(cols);
+    auto dirty_y = y;
+    dirty_y.back() |= ~eccpp::packed_tail_mask(rows);
+    EXPECT_EQ(csc.gf2_multiply(dirty_x), m * x);
+    EXPECT_EQ(csr.gf2_multiply(dirty_x), m * x);
+    EXPECT_EQ(csr.gf2_transpose_multiply(dirty_y), y * m);
+    EXPECT_EQ(csc.gf2_transpose_multiply(dirty_y), y * m);
+
+    EXPECT_THROW(csc.gf2_multiply(y), std::invalid_argument);
+    EXPECT_THROW(csr.gf2_transpose_multiply(x), std::invalid_argument);
+}
+
+TEST(SparseTest, ParallelSplitsByNonzeros) {
+    // 8 rows with 1, 0, 9, 2, 2, 0, 2, 8 nonzeros: nonzeros 0, 6, 12 and 18 start the 4 ranges of
+    // 6, which puts the boundaries at rows 3, 4 and 8
+    const std::vector<size_t> offsets = {0, 1, 1, 10, 12, 14, 14, 16, 24};
+    std::mutex mutex;
+    std::vector<std::pair<size_t, size_t>> ranges;
+    std::set<std::thread::id> threads;
+    eccpp::detail::for_each_sparse_range(eccpp::execution::par(4), offsets, 1, [&](size_t begin, size_t end) {
+        std::lock_guard lock(mutex);
+        ranges.emplace_back(begin, end);
+        threads.insert(std::this_thread::get_id());
+    }, 6);
+    std::sort(ranges.begin(), ranges.end());
+    EXPECT_EQ(ranges, (std::vector<std::pair<size_t, size_t>>{{0, 3}, {3, 4}, {4, 8}}));
+    EXPECT_EQ(threads.size(), 3u);
+
+    // boundaries on multiples of the alignment, every line covered once
+    ranges.clear();
+    eccpp::detail::for_each_sparse_range(eccpp::execution::par(4), offsets, 4, [&](size_t begin, size_t end) {
+        std::lock_guard lock(mutex);
+        ranges.emplace_back(begin, end);
+    }, 6);
+    std::sort(ranges.begin(), ranges.end());
+    EXPECT_EQ(ranges, (std::vector<std::pair<size_t, size_t>>{{0, 4}, {4, 8}}));
+
+    // G_4096 has 3^12 = 531441 nonzeros, enough for 4 threads under the default threshold
+    const auto csr = eccpp::gn_csr(4096);
+    std::vector<int> xb(4096);
+    for (size_t i = 0; i < xb.size(); ++i)
+        xb[i] = int(i % 7 < 3);
+    const auto x = eccpp::pack_bits(xb);
+    EXPECT_EQ(csr.gf2_multiply(eccpp::execution::par(4), x), csr.gf2_multiply(x));
+
+    EXPECT_EQ(csr.multiply(eccpp::execution::par(4), xb), csr.multiply(xb));
+}